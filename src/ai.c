@@ -1,35 +1,176 @@
 #include "ai.h"
+#include "endgame.h"
+#include "frontier.h"
+#include "occupancy.h"
+#include "pile.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include "tile_tables.h"
+#include <stdatomic.h>
 #include <time.h>
 #include <limits.h>
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 
 #define ROTATION_MOVES 4
 
+// weights of the static evaluator
+#define EVAL_EDGE_MATCHED       1
+#define EVAL_CASTLE_CLOSED      2
+#define EVAL_ROAD_CLOSED        1
+#define EVAL_CASTLE_OPEN        1
+#define EVAL_TEMPLE_NEIGHBOUR   1
+
+// kinds of tiles generated between two looks at the clock
+#define DEADLINE_CHECK_TILES    16
+
+// exact scoring is spread over the scheduler from this many candidates on,
+// below it copying the board for every worker costs more than it saves
+#define PARALLEL_MIN_CANDIDATES 64
+// candidates scored by one task
+#define PARALLEL_GRAIN          8
+
+static const int rowStep[4] = { -1, 0, 1, 0 };
+static const int columnStep[4] = { 0, 1, 0, -1 };
+
+typedef struct {
+    size_t row, column, tileIndex, rotation;
+    int estimate;
+} candidate;
+
+// snapshot of the board, pile and scorer of one scheduler worker, set up on its first task.
+// the snapshot shares the tiles of the board, only the pile is copied since it gets rotated
+typedef struct {
+    board_snapshot board;
+    tile** pile;
+    scorer s;
+    bool ready;
+} exact_worker;
+
+// exact scoring of the ranked candidates on the scheduler
+typedef struct {
+    const sized_board* board;
+    const sized_tlist* list;
+    const ai_config* config;
+    const candidate* candidates;
+    int* values;                // INT_MIN for candidates left out by the deadline
+    exact_worker* workers;
+    atomic_bool cut;
+    atomic_size_t evaluated;
+} exact_job;
+
 void ai_makeMove(sized_board* board,sized_tlist* list,move* m) {
     if(m == NULL) {
         puts("No more moves available");
         return;
     }
 
-    tile* t = tlist_eraseAt(list,move_getTileIndex(m));
+    // the board frees its tiles, so it gets one of its own
+    tile* t = tlist_detach(list,tlist_eraseAt(list,move_getTileIndex(m)));
     tile_rotate_amount(move_getRotation(m),t);
     board->tiles[move_getRow(m)][move_getColumn(m)] = t;
     move_free(&m);
 }
 
-move* ai_bruteForce(sized_board* board, sized_tlist* list) {
-    bool placed = false;
-    int best = INT_MIN, row,column,value,rotations;
-    point* maxPoint = NULL;
-    move* bestMove = move_default();
+// true if a ranks before b: the higher score, on a tie the move the exhaustive search meets first
+static bool rankedBefore(const move* a, const move* b) {
+    if(a->score != b->score) return a->score > b->score;
+    if(a->row != b->row) return a->row < b->row;
+    if(a->column != b->column) return a->column < b->column;
+    if(a->tileIndex != b->tileIndex) return a->tileIndex < b->tileIndex;
+    return a->rotation < b->rotation;
+}
+
+// the kept moves form a heap with the one ranked last at the root
+static void rankSiftDown(move* heap, size_t count, size_t i) {
+    while(true) {
+        size_t worst = i, l = 2 * i + 1, r = l + 1;
+        if(l < count && rankedBefore(&heap[worst], &heap[l])) worst = l;
+        if(r < count && rankedBefore(&heap[worst], &heap[r])) worst = r;
+        if(worst == i) return;
+        move temp = heap[i]; heap[i] = heap[worst]; heap[worst] = temp;
+        i = worst;
+    }
+}
 
-    // get the List of Points for available moves
-    List* moves = getAllPossibleMoves(board);
+static void rankSiftUp(move* heap, size_t i) {
+    while(i > 0 && rankedBefore(&heap[(i - 1) / 2], &heap[i])) {
+        move temp = heap[i]; heap[i] = heap[(i - 1) / 2]; heap[(i - 1) / 2] = temp;
+        i = (i - 1) / 2;
+    }
+}
 
-    for(int i = 0; i < List_getSize(moves); i++) {
-        point* p = List_getPoint(moves,i);
-        row = point_getRow(p); column = point_getColumn(p);
-        for(int j = 0; j < list->size; j++) {
+// watches the edges of every rotation of every tile of the list
+static void watchPile(frontier* cells, const sized_tlist* list) {
+    for(size_t j = 0; j < list->size; j++) {
+        size_t code = tile_code(list->tiles[j]);
+        for(size_t k = 0; k < ROTATION_MOVES; k++) {
+            frontier_watch(cells, tile_infos[code].edges);
+            code = tile_infos[code].rotated;
+        }
+    }
+}
+
+// bit k is set if the tile turned clockwise k times fits some cell of the watched frontier
+static unsigned fittingRotations(const frontier* cells, const tile* t) {
+    size_t code = tile_code(t);
+    unsigned fitting = 0;
+    for(size_t k = 0; k < ROTATION_MOVES; k++) {
+        if(frontier_fits(cells, tile_infos[code].edges)) fitting |= 1u << k;
+        code = tile_infos[code].rotated;
+    }
+    return fitting;
+}
+
+size_t ai_rankMoves(sized_board* board, sized_tlist* list, move* ranked, size_t capacity, ai_stats* stats) {
+    size_t kept = 0;
+    int rotations;
+    scorer s;
+    scorer_init(&s);
+
+    // the edges of the pile in one byte array, the tiles fitting a cell are found by a vector scan of it.
+    // the edges of every rotation form one set too, a cell none of them fits is not scanned at all
+    tile_pile tiles;
+    pile_init(&tiles);
+    pile_fromList(&tiles, list);
+    edge_set pile = { { 0 } };
+    for(size_t j = 0; j < tiles.size; j++) {
+        unsigned edges = tiles.edges[j];
+        for(size_t k = 0; k < ROTATION_MOVES; k++, edges = ((edges << 2) | (edges >> 6)) & 0xFFu) {
+            edge_set_add(&pile, (uint8_t)edges);
+        }
+    }
+    size_t words = (tiles.size + 63) / 64;
+    uint64_t* fitBits = malloc((ROTATION_MOVES + 2) * (words + 1) * sizeof(uint64_t));
+    uint64_t* anyBits = fitBits + ROTATION_MOVES * (words + 1);
+    uint64_t* seenBits = anyBits + words + 1;
+    memset(seenBits, 0, words * sizeof(uint64_t));
+
+    // the temple points follow the candidate tile instead of being counted for every candidate
+    temple_tracker temples;
+    temples_init(&temples, board);
+    scorer_setTemples(&s, &temples);
+
+    // get the cells available for moves
+    move_buffer moves;
+    move_buffer_init(&moves);
+    getAllPossibleMoves(board, &moves);
+
+    for(size_t i = 0; i < moves.count; i++) {
+        int row = moves.records[i].row, column = moves.records[i].column;
+        // the tiles fitting the cell come from its constraint, no tile of the pile among them skips it
+        uint8_t constraint = frontier_constraintAt(board, (size_t)row, (size_t)column);
+        if(!edge_set_intersects(&tile_fitting[constraint], &pile)) continue;
+        for(unsigned k = 0; k < ROTATION_MOVES; k++) {
+            pile_fitting(&tiles, constraint, k, fitBits + k * (words + 1));
+        }
+        for(size_t w = 0; w < words; w++) {
+            anyBits[w] = fitBits[w] | fitBits[words + 1 + w] | fitBits[2 * (words + 1) + w] | fitBits[3 * (words + 1) + w];
+            seenBits[w] |= anyBits[w];
+        }
+        // only the tiles fitting in some rotation are turned, in list order
+        for(size_t j = pile_nextBit(anyBits, words, 0); j < tiles.size; j = pile_nextBit(anyBits, words, j + 1)) {
             // identify to no. of rotations required
             if(tile_isSymmetric(list->tiles[j])) {
                 if(tile_isUniform(list->tiles[j])) {    // if all the sides of a tile are the same
@@ -43,18 +184,25 @@ move* ai_bruteForce(sized_board* board, sized_tlist* list) {
 
             for(int k = 0; k < rotations; k++) {
                 // check if tile is applicable at the point
-                if(tile_can_place(board,list->tiles[j],row,column)) {
-                    // make move
+                if((fitBits[(size_t)k * (words + 1) + j / 64] >> (j % 64)) & 1u) {
+                    // make move, evaluate and undo it
                     board->tiles[row][column] = list->tiles[j];
-                    // evaluate
-                    value = score(board);
-                    // analyze
-                    if(value > best) {
-                        move_set(bestMove,row,column,j,k,-1);
-                        best = value;    
-                    }
-                    // undo move
+                    temples_place(&temples, board, (size_t)row, (size_t)column);
+                    move m = { row, column, (int)j, k, scorer_score(&s, board) };
+                    temples_remove(&temples, board, (size_t)row, (size_t)column);
                     board->tiles[row][column] = NULL;
+                    if(stats) {
+                        stats->candidates++;
+                        stats->evaluated++;
+                    }
+                    // keep the best capacity moves, a full heap drops its last one for a better move
+                    if(kept < capacity) {
+                        ranked[kept] = m;
+                        rankSiftUp(ranked, kept++);
+                    } else if(capacity > 0 && rankedBefore(&m, &ranked[0])) {
+                        ranked[0] = m;
+                        rankSiftDown(ranked, kept, 0);
+                    }
                 }
                 // rotate tile
                 tile_rotate(list->tiles[j]);
@@ -64,44 +212,446 @@ move* ai_bruteForce(sized_board* board, sized_tlist* list) {
         }
     }
 
-    // if failed to get any move 
-    if(best == INT_MIN) {
-        move_free(&bestMove);
-        bestMove = NULL;
+    // taking the last one off the heap again and again leaves the moves best first
+    for(size_t n = kept; n > 1; n--) {
+        move temp = ranked[0]; ranked[0] = ranked[n - 1]; ranked[n - 1] = temp;
+        rankSiftDown(ranked, n - 1, 0);
+    }
+    if(stats) {
+        stats->deadTiles += tiles.size - pile_countBits(seenBits, words);
+    }
+    move_buffer_free(&moves);
+    free(fitBits);
+    pile_free(&tiles);
+    temples_free(&temples);
+    scorer_free(&s);
+    return kept;
+}
+
+static move* bruteForce(sized_board* board, sized_tlist* list, ai_stats* stats) {
+    move best;
+    if(ai_rankMoves(board, list, &best, 1, stats) == 0) {
+        return NULL;
+    }
+    move* bestMove = move_default();
+    *bestMove = best;
+    return bestMove;
+}
+
+move* ai_bruteForce(sized_board* board, sized_tlist* list) {
+    return bruteForce(board, list, NULL);
+}
+
+double ai_clockMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e3 + (double)now.tv_nsec / 1e6;
+}
+
+bool ai_deadlinePassed(const ai_config* config) {
+    return config->deadline > 0 && ai_clockMs() >= config->deadline;
+}
+
+static const tile* neighbourAt(const sized_board* board, size_t row, size_t column, int dr, int dc) {
+    if((dr < 0 && row == 0) || (dc < 0 && column == 0)
+            || (dr > 0 && row + 1 >= board->size) || (dc > 0 && column + 1 >= board->size)) {
+        return NULL;
+    }
+    return board->tiles[(size_t)((ptrdiff_t)row + dr)][(size_t)((ptrdiff_t)column + dc)];
+}
+
+// estimate with the occupied cells and temples around the cell already counted
+static int staticEvalCounts(const sized_board* board, const tile* t, size_t row, size_t column,
+                            int occupied, int temples) {
+    int value = 0;
+
+    // points the tile brings by itself
+    const tile_info* info = tile_info_of(t);
+    value += info->castleBonus + info->segments[CASTLE] + info->segments[ROAD] + info->temple;
+
+    // edges: matched neighbours close features, castle edges facing an empty cell stay open
+    for(direction d = NORTH; d <= WEST; d++) {
+        element e = tile_getSideElement(t, d);
+        if(neighbourAt(board, row, column, rowStep[d], columnStep[d])) {
+            value += EVAL_EDGE_MATCHED;
+            if(e == CASTLE) value += EVAL_CASTLE_CLOSED;
+            else if(e == ROAD) value += EVAL_ROAD_CLOSED;
+        } else if(e == CASTLE) {
+            value -= EVAL_CASTLE_OPEN;
+        }
+    }
+
+    // temples around gain a neighbour, a temple placed here gains all the occupied cells
+    value += EVAL_TEMPLE_NEIGHBOUR * temples;
+    if(info->temple) value += EVAL_TEMPLE_NEIGHBOUR * occupied;
+    return value;
+}
+
+int ai_staticEval(const sized_board* board, const tile* t, size_t row, size_t column) {
+    int occupied = 0, temples = 0;
+    for(int dr = -1; dr <= 1; dr++) {
+        for(int dc = -1; dc <= 1; dc++) {
+            const tile* n = (dr || dc) ? neighbourAt(board, row, column, dr, dc) : NULL;
+            if(n) {
+                occupied++;
+                temples += tile_hasTemple(n);
+            }
+        }
+    }
+    return staticEvalCounts(board, t, row, column, occupied, temples);
+}
+
+// number of rotations worth trying for a tile
+static size_t distinctRotations(const tile* t) {
+    return tile_info_of(t)->rotations;
+}
+
+static int candidate_compare(const void* a, const void* b) {
+    const candidate* x = a;
+    const candidate* y = b;
+    if(x->estimate != y->estimate) return (y->estimate > x->estimate) - (y->estimate < x->estimate);
+    if(x->row != y->row) return (x->row > y->row) - (x->row < y->row);
+    if(x->column != y->column) return (x->column > y->column) - (x->column < y->column);
+    if(x->tileIndex != y->tileIndex) return (x->tileIndex > y->tileIndex) - (x->tileIndex < y->tileIndex);
+    return (x->rotation > y->rotation) - (x->rotation < y->rotation);
+}
+
+static void exactScoreRange(void* arg, size_t begin, size_t end, size_t worker) {
+    exact_job* job = arg;
+    exact_worker* w = &job->workers[worker];
+    if(!w->ready) {
+        snapshot_init(&w->board, job->board);
+        w->pile = malloc(job->list->size * sizeof(tile*));
+        for(size_t j = 0; j < job->list->size; j++) {
+            w->pile[j] = tile_alloc_from_tile(job->list->tiles[j]);
+        }
+        scorer_init(&w->s);
+        w->ready = true;
+    }
+    for(size_t i = begin; i < end; i++) {
+        // the best candidate is always scored, the rest only while there is time
+        if(i > 0 && (atomic_load_explicit(&job->cut, memory_order_relaxed) || ai_deadlinePassed(job->config))) {
+            atomic_store_explicit(&job->cut, true, memory_order_relaxed);
+            break;
+        }
+        const candidate* c = &job->candidates[i];
+        tile* t = w->pile[c->tileIndex];
+        tile_rotate_amount((rotation_t)c->rotation, t);
+        snapshot_place(&w->board, c->row, c->column, t);
+        job->values[i] = scorer_score(&w->s, &w->board.board);
+        snapshot_reset(&w->board);
+        tile_rotate_amount((rotation_t)((ROTATION_MOVES - c->rotation) % ROTATION_MOVES), t);
+        atomic_fetch_add_explicit(&job->evaluated, 1, memory_order_relaxed);
+    }
+}
+
+// scores the first count candidates as scheduler tasks, returns whether the deadline cut it short
+static bool exactScoreParallel(scheduler* pool, const sized_board* board, const sized_tlist* list,
+                               const ai_config* config, const candidate* candidates, size_t count,
+                               int* values, size_t* evaluated) {
+    size_t workers = scheduler_workers(pool);
+    exact_job job = { board, list, config, candidates, values, calloc(workers, sizeof(exact_worker)), false, 0 };
+    for(size_t i = 0; i < count; i++) values[i] = INT_MIN;
+    scheduler_for(pool, count, PARALLEL_GRAIN, exactScoreRange, &job);
+    for(size_t k = 0; k < workers; k++) {
+        exact_worker* w = &job.workers[k];
+        if(!w->ready) continue;
+        snapshot_free(&w->board);
+        for(size_t j = 0; j < list->size; j++) {
+            tile_free(w->pile[j]);
+            free(w->pile[j]);
+        }
+        free(w->pile);
+        scorer_free(&w->s);
+    }
+    free(job.workers);
+    *evaluated += atomic_load(&job.evaluated);
+    return atomic_load(&job.cut);
+}
+
+move* ai_orderedSearch(sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats) {
+    ai_stats local = { 0 };
+    size_t count = 0, capacity = 64;
+    candidate* candidates = malloc(capacity * sizeof(candidate));
+    bool cut = false;
+    // the caller's frontier follows the game already, only without one the board is indexed here
+    frontier own;
+    frontier* cells = config->cells;
+    if(!cells) {
+        ai_watchGame(&own, board, list);
+        cells = &own;
+    }
+
+    // neighbour counts of every cell in one sweep instead of eight lookups per candidate
+    occupancy occupied, temples, occupiedCounts[OCCUPANCY_PLANES], templeCounts[OCCUPANCY_PLANES];
+    occupancy_init(&occupied);
+    occupancy_init(&temples);
+    for(size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+        occupancy_init(&occupiedCounts[k]);
+        occupancy_init(&templeCounts[k]);
+    }
+    occupancy_fromBoard(&occupied, &temples, board);
+    occupancy_countNeighbours(&occupied, occupiedCounts);
+    occupancy_countNeighbours(&temples, templeCounts);
+
+    // the first tile of every kind stands for all identical ones
+    size_t firstOfCode[TILE_CODES], copies[TILE_CODES] = { 0 };
+    for(size_t c = 0; c < TILE_CODES; c++) firstOfCode[c] = SIZE_MAX;
+    for(size_t j = list->size; j-- > 0;) {
+        firstOfCode[tile_code(list->tiles[j])] = j;
+        copies[tile_code(list->tiles[j])]++;
+    }
+
+    // generate all legal candidates with their estimates, cells come from the frontier by edge constraint
+    size_t kinds = 0;
+    for(size_t j = 0; j < list->size && !cut; j++) {
+        tile* t = list->tiles[j];
+        size_t code = tile_code(t);
+        if(firstOfCode[code] != j) continue;
+        // a kind fitting nowhere needs no look at the cells
+        if(!fittingRotations(cells, t)) {
+            local.deadTiles += copies[code];
+            continue;
+        }
+        // with nothing generated yet there is no move to answer with, the search goes on until there is
+        if(++kinds % DEADLINE_CHECK_TILES == 0 && count && ai_deadlinePassed(config)) {
+            cut = true;
+        }
+        size_t rotations = distinctRotations(t);
+
+        for(size_t k = 0; k < rotations; k++) {
+            uint8_t keys[FRONTIER_MATCHES];
+            frontier_matchingKeys(tile_info_of(t)->edges, keys);
+            for(size_t m = 0; m < FRONTIER_MATCHES; m++) {
+                size_t cellCount;
+                const size_t* found = frontier_cells(cells, keys[m], &cellCount);
+                // the same tile later in the list gives exactly the same moves
+                local.candidates += cellCount * copies[code];
+                local.duplicates += cellCount * (copies[code] - 1);
+                for(size_t c = 0; c < cellCount; c++) {
+                    size_t row = found[c] / cells->size, column = found[c] % cells->size;
+                    if(count == capacity) {
+                        capacity *= 2;
+                        candidates = realloc(candidates, capacity * sizeof(candidate));
+                    }
+                    int estimate = staticEvalCounts(board, t, row, column, occupancy_countAt(occupiedCounts, row, column),
+                                                    occupancy_countAt(templeCounts, row, column));
+                    candidates[count++] = (candidate){ row, column, j, k, estimate };
+                }
+            }
+            tile_rotate(t);
+        }
+        tile_rotate_amount((rotation_t)(ROTATION_MOVES - rotations), t);
+    }
+    if(cells == &own) frontier_free(&own);
+    occupancy_free(&occupied);
+    occupancy_free(&temples);
+    for(size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+        occupancy_free(&occupiedCounts[k]);
+        occupancy_free(&templeCounts[k]);
+    }
+
+    // rank by estimate, equal estimates in board order so the result does not depend on the generation order
+    qsort(candidates, count, sizeof(candidate), candidate_compare);
+    size_t limit = (config->topK && config->topK < count) ? config->topK : count;
+
+    int best = INT_MIN;
+    move* bestMove = NULL;
+    if(cut && count) {
+        // no time left to score, the estimate has to do
+        candidate* c = &candidates[0];
+        bestMove = move_default();
+        move_set(bestMove, (int)c->row, (int)c->column, (int)c->tileIndex, (int)c->rotation, c->estimate);
+    }
+    scheduler* pool = !cut && limit >= PARALLEL_MIN_CANDIDATES && config->threads != 1
+        ? scheduler_shared(config->threads) : NULL;
+    if(pool && scheduler_workers(pool) > 1) {
+        // same choice as the loop below: the first of the best values in rank order
+        int* values = malloc(limit * sizeof(int));
+        cut = exactScoreParallel(pool, board, list, config, candidates, limit, values, &local.evaluated);
+        for(size_t i = 0; i < limit; i++) {
+            candidate* c = &candidates[i];
+            if(values[i] > best) {
+                if(!bestMove) bestMove = move_default();
+                move_set(bestMove, (int)c->row, (int)c->column, (int)c->tileIndex, (int)c->rotation, values[i]);
+                best = values[i];
+            }
+        }
+        free(values);
+        limit = 0;
+    }
+    for(size_t i = 0; i < limit && !cut; i++) {
+        candidate* c = &candidates[i];
+        // the best candidate is always scored, the rest only while there is time
+        if(i > 0 && ai_deadlinePassed(config)) {
+            cut = true;
+            break;
+        }
+        tile* t = list->tiles[c->tileIndex];
+        tile_rotate_amount((rotation_t)c->rotation, t);
+        board->tiles[c->row][c->column] = t;
+        int value = score(board);
+        board->tiles[c->row][c->column] = NULL;
+        tile_rotate_amount((rotation_t)((ROTATION_MOVES - c->rotation) % ROTATION_MOVES), t);
+        local.evaluated++;
+
+        if(value > best) {
+            if(!bestMove) bestMove = move_default();
+            move_set(bestMove, (int)c->row, (int)c->column, (int)c->tileIndex, (int)c->rotation, value);
+            best = value;
+        }
+    }
+    free(candidates);
+
+    if(stats) {
+        stats->candidates += local.candidates;
+        stats->duplicates += local.duplicates;
+        stats->evaluated += local.evaluated;
+        stats->deadTiles += local.deadTiles;
+        if(cut) stats->cutoffs++;
     }
-   
-    List_free(&moves);
     return bestMove;
 }
 
-List* getAllPossibleMoves(sized_board* board) {
-   List* list = List_new();
+move* ai_exhaustiveSearch(sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats) {
+    (void)config;
+    return bruteForce(board, list, stats);
+}
+
+bool ai_hasMove(const sized_board* board, const sized_tlist* list) {
+    frontier cells;
+    ai_watchGame(&cells, board, list);
+    bool placeable = frontier_placeable(&cells) > 0;
+    frontier_free(&cells);
+    return placeable;
+}
+
+void ai_watchGame(frontier* cells, const sized_board* board, const sized_tlist* list) {
+    frontier_init(cells, board);
+    watchPile(cells, list);
+}
+
+void ai_followMove(frontier* cells, const sized_board* board, size_t row, size_t column) {
+    size_t code = tile_code(board->tiles[row][column]);
+    for(size_t k = 0; k < ROTATION_MOVES; k++) {
+        frontier_unwatch(cells, tile_infos[code].edges);
+        code = tile_infos[code].rotated;
+    }
+    frontier_place(cells, board, row, column);
+    // the game never takes a move back, the log would only grow
+    frontier_commit(cells);
+}
+
+move* ai_search(ai_strategy strategy, sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats) {
+    // a pile without any legal placement is told apart before any search,
+    // a frontier following the game answers that without looking at the board
+    if(config->cells ? frontier_placeable(config->cells) == 0 : !ai_hasMove(board, list)) {
+        if(stats) stats->deadTiles += list->size;
+        return NULL;
+    }
+    move* m = endgame_search(board, list, config, stats);
+    return m ? m : strategy(board, list, config, stats);
+}
+
+size_t ai_playGame(sized_board* board, sized_tlist* list, ai_strategy strategy, const ai_config* config, ai_stats* stats) {
+    size_t moves = 0;
+    move* m;
+    ai_config turn = *config;
+    frontier cells;
+    ai_watchGame(&cells, board, list);
+    turn.cells = &cells;
+    while(list->size > 0) {
+        if(config->deadlineMs) {
+            turn.deadline = ai_clockMs() + (double)config->deadlineMs;
+        }
+        if((m = ai_search(strategy, board, list, &turn, stats)) == NULL) {
+            break;
+        }
+        size_t row = (size_t)move_getRow(m), column = (size_t)move_getColumn(m);
+        ai_makeMove(board, list, m);
+        moves++;
+        // keep a free margin around the tiles as auto mode does between runs, the cells move then
+        // and the frontier is built again. as long as the margin holds it follows the move
+        if(row == 0 || column == 0 || row + 1 == board->size || column + 1 == board->size) {
+            board_trim(board);
+            board_resize(board->size + 2, board);
+            frontier_free(&cells);
+            ai_watchGame(&cells, board, list);
+        } else {
+            ai_followMove(&cells, board, row, column);
+        }
+    }
+    frontier_free(&cells);
+    return moves;
+}
+
+void ai_printStats(const ai_stats* stats) {
+    size_t pruned = stats->candidates - stats->evaluated;
+    if(stats->candidates || (!stats->playouts && !stats->endgameSearches && !stats->planPositions)) {
+        printf("candidates: %zu, duplicates: %zu, evaluated: %zu, pruned: %zu (%.1f%%)\n",
+               stats->candidates, stats->duplicates, stats->evaluated, pruned,
+               stats->candidates ? 100.0 * (double)pruned / (double)stats->candidates : 0.0);
+    }
+    if(stats->deadTiles) {
+        printf("dead tiles: %zu skipped, they fit no cell\n", stats->deadTiles);
+    }
+    if(stats->cutoffs) {
+        printf("cut by deadline: %zu searches\n", stats->cutoffs);
+    }
+    if(stats->playouts) {
+        printf("playouts: %zu in %.3f s (%.0f/s)\n", stats->playouts, stats->seconds,
+               stats->seconds > 0 ? (double)stats->playouts / stats->seconds : 0.0);
+    }
+    if(stats->endgameSearches) {
+        printf("endgame: %zu of %zu searches solved, %zu nodes in %.3f s\n", stats->endgameSolved,
+               stats->endgameSearches, stats->endgameNodes, stats->endgameSeconds);
+        printf("bound: %zu positions cut (%.1f%%), %.1f points above the solved score\n", stats->endgameCuts,
+               stats->endgameNodes ? 100.0 * (double)stats->endgameCuts / (double)stats->endgameNodes : 0.0,
+               stats->endgameSolved ? (double)stats->endgameBoundGap / (double)stats->endgameSolved : 0.0);
+    }
+    if(stats->planPositions) {
+        printf("plan: %zu positions, %zu merged (%.1f%%)\n", stats->planPositions, stats->planMerged,
+               100.0 * (double)stats->planMerged / (double)stats->planPositions);
+    }
+}
+
+size_t getAllPossibleMoves(sized_board* board, move_buffer* moves) {
+   move_buffer_clear(moves);
 
    if(board_is_empty(board)) {
        // if board is empty - the optimal solution will be to place tile in the middle of the board
-       List_addFirst(list,point_new((board->size)/2,(board->size)/2,0));
+       move_buffer_push(moves,(int)(board->size/2),(int)(board->size/2),-1,-1);
    }
    else
         for(size_t i = 0; i < board->size; i++) {
             for(size_t j = 0; j < board->size; j++) {
                 if(tile_isEmpty(board->tiles[i][j]) && board_tileHasNeighbour(board,i,j)) {
-                    List_addLast(list,point_new(i,j,0)); 
+                    move_buffer_push(moves,(int)i,(int)j,-1,-1);
                 }
             }
         }
-    return list;
+    return moves->count;
 }
 
-List* getMovesForTile(sized_board* board, tile* t) {
-    List* list = List_new();
+size_t getMovesForTile(sized_board* board, tile* t, move_buffer* moves) {
+    move_buffer_clear(moves);
+    if(board_is_empty(board)) {
+        if(board->size) move_buffer_push(moves,(int)(board->size/2),(int)(board->size/2),-1,-1);
+        return moves->count;
+    }
+
+    // one table lookup per empty cell instead of comparing the tile with every neighbour
+    uint8_t edges = tile_info_of(t)->edges;
     for(size_t i = 0; i < board->size; i++) {
         for(size_t j = 0; j < board->size; j++) {
-            if(tile_can_place(board,t,j,i)) {
-                List_addLast(list,point_new(i,j,0)); 
+            if(board->tiles[i][j]) continue;
+            uint8_t key = frontier_constraintAt(board, i, j);
+            if(key != FRONTIER_OPEN && edge_set_has(&tile_fitting[key], edges)) {
+                move_buffer_push(moves,(int)i,(int)j,-1,-1);
             }
         }
     }
-    return list;
+    return moves->count;
 }
 
 int getEmptyCells(sized_board* board) {
@@ -7,6 +7,55 @@
 #include "board.h"
 #include "tlist.h"
 #include "calculator.h"
+#include "frontier.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+* search settings shared by the strategies
+*/
+typedef struct {
+    size_t topK;        ///< candidates passed on to exact scoring, 0 scores all of them
+    size_t threads;     ///< worker threads, 0 uses one per online cpu
+    size_t nodes;       ///< mcts: tree nodes to add before answering
+    size_t timeMs;      ///< mcts: wall-clock limit in milliseconds, 0 for none
+    size_t horizon;     ///< mcts: tiles placed by a rollout past the tree, 0 for the whole pile
+    size_t deadlineMs;  ///< time budget of one move, 0 for none
+    double deadline;    ///< {@code ai_clockMs} time by which a move must be chosen, 0 for none
+    size_t endgameTiles; ///< pile size from which on the rest of the game is solved exactly, 0 for never
+    size_t planWindow;  ///< plan: tiles of the deal looked ahead before placing one
+    size_t planBeam;    ///< plan: positions kept at every depth of the lookahead
+    frontier* cells;    ///< frontier of the board with the pile watched, kept up to date by the caller, NULL for one per search
+} ai_config;
+
+#define AI_CONFIG_DEFAULT { 0, 0, 20000, 0, 8, 0, 0, 0, 3, 16, NULL }
+
+/**
+* counters collected during a search
+*/
+typedef struct {
+    size_t candidates;  ///< legal (cell, tile, rotation) triples generated
+    size_t duplicates;  ///< candidates dominated by an identical tile at the same place
+    size_t evaluated;   ///< candidates evaluated with score()
+    size_t cutoffs;     ///< searches stopped by the deadline before scoring every candidate
+    size_t deadTiles;   ///< tiles of the pile skipped because they fit no cell
+    size_t playouts;    ///< mcts: rollouts played
+    double seconds;     ///< mcts: time spent searching
+    size_t endgameSearches; ///< endgame: searches started
+    size_t endgameSolved;   ///< endgame: searches that reached the end of the game
+    size_t endgameNodes;    ///< endgame: positions visited
+    size_t endgameCuts;     ///< endgame: positions cut by the score bound
+    size_t endgameBoundGap; ///< endgame: bound minus result summed over the solved searches
+    double endgameSeconds;  ///< endgame: time spent searching
+    size_t planPositions;   ///< plan: positions generated by the lookahead
+    size_t planMerged;      ///< plan: positions dropped because another line reached them
+} ai_stats;
+
+/**
+* signature of a move search strategy
+*/
+typedef move* (*ai_strategy)(sized_board*, sized_tlist*, const ai_config*, ai_stats*);
 
 /**
 * Finds the best move by Brute Force Search Algorithm 
@@ -16,6 +65,130 @@
 */
 move* ai_bruteForce(sized_board* board, sized_tlist* list);
 
+/**
+* Scores every candidate like {@code ai_bruteForce} and writes the best of them, best first.
+* ties keep the order the search meets the candidates in, so the first move is the one
+* ai_bruteForce picks. with fewer slots than candidates the best ones are kept in a bounded heap
+* instead of sorting them all
+* @param [in] game board
+* @param [in] list with available tiles
+* @param [out] ranked buffer for the moves with their scores
+* @param [in] capacity amount of moves the buffer holds
+* @param [out] search counters, may be NULL
+* @return amount of moves written, smaller than capacity when there are fewer candidates
+*/
+size_t ai_rankMoves(sized_board* board, sized_tlist* list, move* ranked, size_t capacity, ai_stats* stats);
+
+/**
+* Monotonic clock used for deadlines and timing
+* @return milliseconds since an unspecified point
+*/
+double ai_clockMs(void);
+
+/**
+* Checks whether the deadline of the configuration has passed
+* @param [in] search settings
+* @return true if there is a deadline and it is over
+*/
+bool ai_deadlinePassed(const ai_config* config);
+
+/**
+* Cheap estimate of the value of placing a tile, used to order candidates.
+* Looks only at the cell's 3x3 neighbourhood: edges matched, castle and road
+* edges closed, temple neighbours gained and castle edges left open
+* @param [in] game board
+* @param [in] tile in the rotation it would be placed
+* @param [in] row of the cell
+* @param [in] column of the cell
+* @return estimate, higher is better
+*/
+int ai_staticEval(const sized_board* board, const tile* t, size_t row, size_t column);
+
+/**
+* Finds the best move by ranking all candidates with {@code ai_staticEval}
+* and scoring only the best config->topK of them exactly.
+* Identical tiles at the same place are pruned as dominated.
+* The search is anytime: candidates are scored in rank order and once
+* config->deadline passes the best move found so far is returned,
+* stats->cutoffs tells that the search was not exhaustive
+* @param [in] game board
+* @param [in] list with available tiles
+* @param [in] search settings
+* @param [out] search counters, may be NULL
+* @return best move found, NULL if there is none
+*/
+move* ai_orderedSearch(sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats);
+
+/**
+* {@code ai_bruteForce} wrapped as an {@code ai_strategy}
+* @param [in] game board
+* @param [in] list with available tiles
+* @param [in] search settings, unused
+* @param [out] search counters, may be NULL
+* @return best move
+*/
+move* ai_exhaustiveSearch(sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats);
+
+/**
+* Tells whether any tile of the list fits any cell of the board, from a frontier index
+* that counts the cells every rotation of the tiles fits without looking at them one by one
+* @param [in] game board
+* @param [in] list with available tiles
+* @return false if no move is left
+*/
+bool ai_hasMove(const sized_board* board, const sized_tlist* list);
+
+/**
+* Builds the frontier of a board with every rotation of the tiles of the list watched,
+* as {@code ai_config::cells} expects it
+* @param [out] frontier to initialize
+* @param [in] game board
+* @param [in] list with available tiles
+*/
+void ai_watchGame(frontier* cells, const sized_board* board, const sized_tlist* list);
+
+/**
+* Follows a move on the frontier of {@code ai_watchGame}: the placed tile stops being watched
+* and only the cell and its neighbours are looked at
+* @param [in, out] frontier of the board
+* @param [in] game board with the tile already placed
+* @param [in] row of the placed tile
+* @param [in] column of the placed tile
+*/
+void ai_followMove(frontier* cells, const sized_board* board, size_t row, size_t column);
+
+/**
+* Finds a move with the endgame solver once few enough tiles are left,
+* with the strategy before that and when the solver finds nothing in its budget
+* @param [in] strategy used outside of the endgame
+* @param [in] game board
+* @param [in] list with available tiles
+* @param [in] search settings
+* @param [out] search counters, may be NULL
+* @return best move found, NULL if there is none
+*/
+move* ai_search(ai_strategy strategy, sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats);
+
+/**
+* Plays moves chosen by {@code ai_search} with the strategy until no move is left,
+* the board is trimmed and given a margin like in auto mode whenever a tile reaches its border,
+* the frontier of the board is kept from move to move and only built again then.
+* every move gets config->deadlineMs to be found
+* @param [in, out] game board
+* @param [in, out] list with available tiles
+* @param [in] strategy choosing the moves
+* @param [in] search settings
+* @param [out] accumulated search counters, may be NULL
+* @return number of moves made
+*/
+size_t ai_playGame(sized_board* board, sized_tlist* list, ai_strategy strategy, const ai_config* config, ai_stats* stats);
+
+/**
+* Prints search counters
+* @param [in] search counters
+*/
+void ai_printStats(const ai_stats* stats);
+
 /**
 * Makes the move: takes a tile from the lsit and places it on the board
 * @param [in] game board
@@ -27,17 +200,19 @@ void ai_makeMove(sized_board* board, sized_tlist* list, move* m);
 /**
 * Determines all board's cells available for moves 
 * @param [in] game board
-* @return list of cells available for moves
+* @param [out] moves cleared and filled with the cells in board order, tile and rotation -1
+* @return number of cells available for moves
 */
-List* getAllPossibleMoves(sized_board* board);
+size_t getAllPossibleMoves(sized_board* board, move_buffer* moves);
 
 /**
 * Determines all board's cells available for the tile to be placed
 * @param [in] game board
 * @param [in] tile to be placed
-* @return list of cells available for moves
+* @param [out] moves cleared and filled with the cells in board order, tile and rotation -1
+* @return number of cells available for moves
 */
-List* getMovesForTile(sized_board* board, tile* t);
+size_t getMovesForTile(sized_board* board, tile* t, move_buffer* moves);
 
 /**
 * Determines the number of free cells
@@ -0,0 +1,242 @@
+#include "batch.h"
+#include "calculator.h"
+#include "scheduler.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+typedef struct {
+    score_detailed score;
+    size_t size;
+    bool ok;
+} batch_result;
+
+typedef struct batch_job batch_job;
+
+typedef struct {
+    batch_job* job;
+    const char* path;
+    batch_result result;
+} batch_slot;
+
+struct batch_job {
+    scorer* scorers;        // one per worker of the scheduler
+    batch_slot* slots;      // two blocks of window boards, one is scored while the other is written
+    size_t window;
+};
+
+static void paths_add(char*** paths, size_t* count, size_t* capacity, const char* path) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        *paths = realloc(*paths, *capacity * sizeof(char*));
+    }
+    (*paths)[(*count)++] = strdup(path);
+}
+
+static int path_compare(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static bool collect_directory(const char* name, char*** paths, size_t* count, size_t* capacity) {
+    DIR* dir;
+    if ((dir = opendir(name)) == 0) {
+        return false;
+    }
+    size_t first = *count;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != 0) {
+        size_t length = strlen(name) + strlen(entry->d_name) + 2;
+        char* path = malloc(length);
+        snprintf(path, length, "%s/%s", name, entry->d_name);
+        struct stat info;
+        if (stat(path, &info) == 0 && S_ISREG(info.st_mode)) {
+            paths_add(paths, count, capacity, path);
+        }
+        free(path);
+    }
+    closedir(dir);
+    qsort(*paths + first, *count - first, sizeof(char*), path_compare);
+    return true;
+}
+
+static bool collect_list(const char* name, char*** paths, size_t* count, size_t* capacity) {
+    FILE* file;
+    if ((file = fopen(name, "r")) == 0) {
+        return false;
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0]) {
+            paths_add(paths, count, capacity, line);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+char** batch_collect(int argc, char* argv[], size_t* count) {
+    char** paths = NULL;
+    size_t capacity = 0;
+    *count = 0;
+    for (int i = 0; i < argc; ++i) {
+        struct stat info;
+        bool ok = true;
+        if (argv[i][0] == '@') {
+            ok = collect_list(argv[i] + 1, &paths, count, &capacity);
+        } else if (stat(argv[i], &info) == 0 && S_ISDIR(info.st_mode)) {
+            ok = collect_directory(argv[i], &paths, count, &capacity);
+        } else {
+            paths_add(&paths, count, &capacity, argv[i]);
+        }
+        if (!ok) {
+            fprintf(stderr, "error reading %s\n", argv[i]);
+            batch_freePaths(paths, *count);
+            *count = 0;
+            return NULL;
+        }
+    }
+    if (!paths) {
+        paths = malloc(sizeof(char*));
+    }
+    return paths;
+}
+
+void batch_freePaths(char** paths, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        free(paths[i]);
+    }
+    free(paths);
+}
+
+static batch_result score_file(scorer* s, const char* path) {
+    batch_result result = { { 0 }, 0, false };
+    FILE* file;
+    if ((file = fopen(path, "r")) == 0) {
+        return result;
+    }
+    sized_board board = { 0, board_get_size(path) };
+    if (board.size == 0) {
+        // an empty board is fine, a size of 0 is also how a bad file is reported
+        int ch;
+        while ((ch = getc(file)) != EOF && isspace(ch)) { ; }
+        result.ok = ch == EOF;
+        fclose(file);
+        return result;
+    }
+    fclose(file);
+    board.tiles = board_alloc(board.size);
+    if (board_parse(path, &board)) {
+        score_detailed_init(&result.score, false);
+        scorer_scoreDetailed(s, &board, &result.score);
+        result.size = board.size;
+        result.ok = true;
+    }
+    board_free(&board);
+    return result;
+}
+
+static void score_slot(void* arg, size_t worker) {
+    batch_slot* slot = arg;
+    slot->result = score_file(&slot->job->scorers[worker], slot->path);
+}
+
+// spawns the boards of a block, the block uses half of the slots
+static void spawn_block(scheduler* s, scheduler_group* g, batch_job* job, char* const* paths, size_t count,
+                        size_t block) {
+    size_t first = block * job->window;
+    batch_slot* slots = job->slots + (block % 2) * job->window;
+    for (size_t i = first; i < count && i < first + job->window; ++i) {
+        slots[i - first] = (batch_slot){ job, paths[i], { { 0 }, 0, false } };
+        scheduler_spawn(s, g, score_slot, &slots[i - first]);
+    }
+}
+
+static void write_csv_field(FILE* out, const char* str) {
+    if (strpbrk(str, ",\"\n\r") == NULL) {
+        fputs(str, out);
+        return;
+    }
+    putc('"', out);
+    for (; *str; ++str) {
+        if (*str == '"') {
+            putc('"', out);
+        }
+        putc(*str, out);
+    }
+    putc('"', out);
+}
+
+static void write_json_string(FILE* out, const char* str) {
+    putc('"', out);
+    for (; *str; ++str) {
+        unsigned char ch = (unsigned char)*str;
+        if (ch == '"' || ch == '\\') {
+            putc('\\', out);
+            putc(ch, out);
+        } else if (ch < 0x20) {
+            fprintf(out, "\\u%04x", ch);
+        } else {
+            putc(ch, out);
+        }
+    }
+    putc('"', out);
+}
+
+static void write_result(FILE* out, batch_format format, const char* path, const batch_result* r) {
+    if (format == BATCH_CSV) {
+        write_csv_field(out, path);
+        if (r->ok) {
+            fprintf(out, ",%zu,%d,%d,%d,%d,\n", r->size, r->score.castle, r->score.road, r->score.temple, r->score.total);
+        } else {
+            fputs(",,,,,,parse error\n", out);
+        }
+    } else {
+        fputs("{\"file\":", out);
+        write_json_string(out, path);
+        if (r->ok) {
+            fprintf(out, ",\"size\":%zu,\"castle\":%d,\"road\":%d,\"temple\":%d,\"score\":%d}\n",
+                    r->size, r->score.castle, r->score.road, r->score.temple, r->score.total);
+        } else {
+            fputs(",\"error\":\"parse error\"}\n", out);
+        }
+    }
+}
+
+size_t batch_score(char* const* paths, size_t count, size_t threads, batch_format format, FILE* out) {
+    scheduler* s = scheduler_shared(threads);
+    size_t workers = scheduler_workers(s);
+    batch_job job = { malloc(workers * sizeof(scorer)), NULL, workers * BATCH_WINDOW };
+    job.slots = malloc(2 * job.window * sizeof(batch_slot));
+    for (size_t i = 0; i < workers; ++i) {
+        scorer_init(&job.scorers[i]);
+    }
+
+    if (format == BATCH_CSV) {
+        fputs("file,size,castle,road,temple,score,error\n", out);
+    }
+    size_t failed = 0;
+    scheduler_group groups[2] = { SCHEDULER_GROUP_INIT, SCHEDULER_GROUP_INIT };
+    spawn_block(s, &groups[0], &job, paths, count, 0);
+    for (size_t block = 0; block * job.window < count; ++block) {
+        // the next block is scored while this one is written
+        spawn_block(s, &groups[(block + 1) % 2], &job, paths, count, block + 1);
+        scheduler_wait(s, &groups[block % 2]);
+        batch_slot* slots = job.slots + (block % 2) * job.window;
+        for (size_t i = block * job.window; i < count && i < (block + 1) * job.window; ++i) {
+            const batch_result* result = &slots[i - block * job.window].result;
+            failed += !result->ok;
+            write_result(out, format, paths[i], result);
+        }
+    }
+
+    for (size_t i = 0; i < workers; ++i) {
+        scorer_free(&job.scorers[i]);
+    }
+    free(job.scorers);
+    free(job.slots);
+    return failed;
+}
@@ -0,0 +1,53 @@
+#ifndef BATCH_H
+#define BATCH_H
+/** @file batch.h */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/** @addtogroup Batch
+* scoring of many saved board files on the shared scheduler
+* @{
+*/
+typedef enum {
+    BATCH_CSV,
+    BATCH_JSON
+} batch_format;
+
+/** boards per worker in a block, one block is scored while the one before it is written */
+#define BATCH_WINDOW 16
+/** @} */
+
+/**
+* collect the board files named by the arguments.
+* a directory gives its regular files sorted by name, an argument starting with @
+* names a file with one path per line, anything else is taken as a board file
+* @param [in] argc amount of arguments
+* @param [in] argv arguments
+* @param [out] count amount of paths
+* @return allocated array of allocated paths, NULL on a directory or list that cannot be read
+*/
+char** batch_collect(int argc, char* argv[], size_t* count);
+
+/**
+* free paths returned by batch_collect.
+* @param [in] paths array of paths
+* @param [in] count amount of paths
+*/
+void batch_freePaths(char** paths, size_t count);
+
+/**
+* parse and score board files as scheduler tasks, write one line per board in the order of paths.
+* csv output starts with a header line, json output is one object per line.
+* a board that cannot be parsed gets a line with an error instead of the scores
+* @param [in] paths board files
+* @param [in] count amount of board files
+* @param [in] threads workers of the shared scheduler if it is not started yet, 0 uses every cpu
+* @param [in] format output format
+* @param [out] out output stream
+* @return amount of boards that could not be parsed
+*/
+size_t batch_score(char* const* paths, size_t count, size_t threads, batch_format format, FILE* out);
+
+#endif
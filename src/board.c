@@ -1,4 +1,5 @@
 #include "board.h"
+#include "fileio.h"
 
 #include <ctype.h>
 #include <stdlib.h>
@@ -22,11 +23,59 @@ size_t board_get_size_interactive() {
     return ret;
 }
 
+// reads the header from the start of the file and leaves the file after it,
+// without a header the file is rewound. returns 1 for a header, 0 for none and -1 for a bad one
+static int read_header(FILE* file, board_header* header) {
+    int ch = getc(file);
+    if (ch != '#') {
+        rewind(file);
+        return 0;
+    }
+    char line[128];
+    if (!fgets(line, sizeof(line), file) || !strchr(line, '\n')) {
+        return -1;
+    }
+    board_header h;
+    int used = 0;
+    if (sscanf(line, "board %zu %zu %ld %ld %n", &h.width, &h.height, &h.row, &h.column, &used) != 4
+        || line[used] != '\0') {
+        return -1;
+    }
+    // every cell takes at least a byte, larger dimensions can only come from a broken file
+    long start = ftell(file);
+    if (start < 0 || fseek(file, 0, SEEK_END) != 0) {
+        return -1;
+    }
+    long end = ftell(file);
+    if (end < 0 || fseek(file, start, SEEK_SET) != 0
+        || h.width > (size_t)end || h.height > (size_t)end) {
+        return -1;
+    }
+    *header = h;
+    return 1;
+}
+
+bool board_read_header(const char* filename, board_header* header) {
+    FILE* file;
+    if ((file = fopen(filename, "r")) == 0) {
+        return false;
+    }
+    bool found = read_header(file, header) > 0;
+    fclose(file);
+    return found;
+}
+
 size_t board_get_size(const char* filename) {
     FILE* file;
     if ((file = fopen(filename, "r")) == 0) {
         return false;
     }
+    board_header header;
+    int status = read_header(file, &header);
+    if (status != 0) {
+        fclose(file);
+        return status > 0 ? MAX(header.width, header.height) : 0;
+    }
     int ch;
     size_t row = 0, col = 0, col_max = 0;
     size_t count = 0;
@@ -130,8 +179,13 @@ bool tile_can_place(const sized_board* board,
     if (board_is_empty(board)) {
         return true;
     }
+    return tile_fits(board, t, y, x);
+}
+
+bool tile_fits(const sized_board* board,
+               const tile* t, size_t y, size_t x) {
     // if out of bounds return false
-    if (y > board->size || x > board->size) {
+    if (y >= board->size || x >= board->size) {
         return false;
     }
     // return false if target cell is already populated
@@ -186,12 +240,80 @@ void tile_place(tile** place, tile* t) {
     *place = t;
 }
 
+// parses the cells of one line into row, a NULL row only accepts blank lines
+static bool parse_row(const char* p, const char* end, tile** row, size_t width) {
+    char str[5];
+    size_t j = 0, count = 0;
+    for (; p < end; ++p) {
+        if (!row && (*p == '\t' || !isspace((unsigned char)*p))) {
+            return false;
+        }
+        if (*p == '\t') {
+            if (count != 0 || ++j > width) {
+                return false;
+            }
+            continue;
+        }
+        if (isspace((unsigned char)*p)) {
+            continue;
+        }
+        str[count++] = *p;
+        if (count == 5) {
+            if (j >= width) {
+                return false;
+            }
+            tile_alloc_from_str(str, &row[j++]);
+            count = 0;
+        }
+    }
+    return count == 0;
+}
+
+// the rest of a file with a header is read at once, the lines are independent of each other
+static bool parse_rows(FILE* file, const board_header* header, sized_board* board) {
+    if (MAX(header->width, header->height) > board->size) {
+        return false;
+    }
+    long start = ftell(file);
+    if (start < 0 || fseek(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    long end = ftell(file);
+    if (end < start || fseek(file, start, SEEK_SET) != 0) {
+        return false;
+    }
+    char* text = malloc((size_t)(end - start) + 1);
+    if (!text) {
+        return false;
+    }
+    const char* p = text;
+    const char* stop = text + fread(text, 1, (size_t)(end - start), file);
+    bool ok = true;
+    for (size_t i = 0; ok && p < stop; ++i) {
+        const char* eol = memchr(p, '\n', (size_t)(stop - p));
+        if (!eol) {
+            eol = stop;
+        }
+        ok = parse_row(p, eol, i < header->height ? board->tiles[i] : NULL, header->width);
+        p = eol + 1;
+    }
+    free(text);
+    return ok;
+}
+
 // TODO: take margin into consideration
 bool board_parse(const char* filename, sized_board* board) {
     FILE* file;
     if ((file = fopen(filename, "r")) == 0) {
         return false;
     }
+    board_header header;
+    int status = read_header(file, &header);
+    if (status != 0) {
+        bool ok = status > 0 && parse_rows(file, &header, board);
+        fclose(file);
+        return ok;
+    }
     int ch;
     char str[5];
     // i: rows, j: columns, count: current tile letter counter
@@ -238,11 +360,12 @@ bool board_parse(const char* filename, sized_board* board) {
 }
 
 void board_print(const sized_board* board) {
-    // pass null tile pointer for can_place_tile to always fail
     board_print_legal_moves(board, 0);
 }
 
-void board_print_legal_moves(const sized_board* board, tile* t) {
+void board_print_legal_moves(const sized_board* board, const move_buffer* moves) {
+    // the moves are in board order, a cursor follows the printed cells
+    size_t next = 0, count = moves ? moves->count : 0;
     // print rows
     for (size_t i = 0; i < board->size; ++i) {
         // print up
@@ -266,7 +389,10 @@ void board_print_legal_moves(const sized_board* board, tile* t) {
                        mod_to_char(board->tiles[i][j]->mod),
                        elem_to_char(board->tiles[i][j]->right->type));
             } else {
-                printf("  %c  ", tile_can_place(board, t, i, j) ? 'x' : ' ');
+                bool marked = next < count && (size_t)moves->records[next].row == i
+                              && (size_t)moves->records[next].column == j;
+                next += marked;
+                printf("  %c  ", marked ? 'x' : ' ');
             }
             if (j < board->size - 1) {
                 putchar('|');
@@ -295,22 +421,41 @@ void board_print_legal_moves(const sized_board* board, tile* t) {
     }
 }
 
-bool board_write(const sized_board* board, const char* filename) {
-    FILE* file;
-    if ((file = fopen(filename, "w")) == 0) {
+// renders the board, with a header line when one is given
+static bool write_board(const sized_board* board, const char* filename, const board_header* header) {
+    // a cell is 5 characters or a tab for an empty one, then a space, a newline ends a row,
+    // tile_to_str stores 5 bytes even for an empty cell so the last one needs room for them
+    size_t headerRoom = header ? 96 : 0;
+    char* text = malloc(headerRoom + board->size * (board->size * 6 + 1) + 5);
+    if (!text) {
         return false;
     }
-    char str[5];
+    char* p = text;
+    if (header) {
+        p += snprintf(p, headerRoom, "#board %zu %zu %ld %ld\n", header->width, header->height, header->row,
+                      header->column);
+    }
     for (size_t i = 0; i < board->size; ++i) {
         for (size_t j = 0; j < board->size; ++j) {
-            fprintf(file,
-                    "%.*s ", 5,
-                    tile_to_str(board->tiles[i][j], str));
+            const tile* t = board->tiles[i][j];
+            tile_to_str(t, p);
+            p += t ? 5 : 1;
+            *p++ = ' ';
         }
-        fprintf(file, "\n");
+        *p++ = '\n';
     }
-    fclose(file);
-    return true;
+    bool ok = fileio_write_atomic(filename, text, (size_t)(p - text));
+    free(text);
+    return ok;
+}
+
+bool board_write(const sized_board* board, const char* filename) {
+    return write_board(board, filename, NULL);
+}
+
+bool board_write_header(const sized_board* board, const char* filename, long row, long column) {
+    board_header header = { board->size, board->size, row, column };
+    return write_board(board, filename, &header);
 }
 
 void board_copy_offsetted(const sized_board* src,
@@ -353,8 +498,8 @@ bool board_tileHasNeighbour(const sized_board* board, size_t i, size_t j) {
         || (j < board->size - 1 && !tile_isEmpty(board->tiles[i][j + 1]));
 }
 
-void board_trim(sized_board* board) {
-    ptrdiff_t dh = 0, dw = 0;
+void board_leading_empty(const sized_board* board, size_t* rows, size_t* columns) {
+    size_t dh = 0, dw = 0;
     bool pre = true, pce = true;
     for (size_t i = 0; i < board->size; ++i) {
         for (size_t j = 0; j < board->size; ++j) {
@@ -364,7 +509,14 @@ void board_trim(sized_board* board) {
         if (pre) { ++dh; }
         if (pce) { ++dw; }
     }
-    board_move(-dh, -dw, board);
+    *rows = dh;
+    *columns = dw;
+}
+
+void board_trim(sized_board* board) {
+    size_t dh, dw;
+    board_leading_empty(board, &dh, &dw);
+    board_move(-(ptrdiff_t)dh, -(ptrdiff_t)dw, board);
     size_t sizeh = 0, sizew = 0;
     bool fre = true, fce = true;
     for (size_t i = board->size; i > 0; --i) {
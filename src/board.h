@@ -2,6 +2,7 @@
 #define BOARD_H
 /** @file board.h */
 
+#include "move.h"
 #include "tile.h"
 
 #include "logic.h"
@@ -15,6 +16,21 @@ typedef struct {
     size_t size;
 } sized_board;
 
+/** @addtogroup BoardHeader
+* optional first line of a board file: {@code #board width height row column}.
+* width and height are the cells of the longest row and the amount of rows,
+* row and column place the top left cell in game coordinates.
+* with it the size is known without scanning the file and every row is parsed on its own
+* @{
+*/
+typedef struct {
+    size_t width;
+    size_t height;
+    long row;
+    long column;
+} board_header;
+/** @} */
+
 /**
  * get size of the game board interactily.
  * @return size of the board
@@ -23,11 +39,20 @@ size_t board_get_size_interactive();
 
 /**
  * get size of the game board traversing trough file.
+ * a file with a header only has its first line read
  * @param fliename name of the board file
  * @return size of the board, (return size of the current board, need to add margin)
  */
 size_t board_get_size(const char*);
 
+/**
+ * reads the header line of a board file.
+ * @param [in] filename name of the board file
+ * @param [out] header dimensions and origin, untouched without a header
+ * @return true if the file starts with a valid header
+ */
+bool board_read_header(const char*, board_header*);
+
 /**
  * allocates a board and sets all tiles to empty (null).
  * remeber to free this, you can use {@code board_free} for this
@@ -77,6 +102,17 @@ bool board_is_empty(const sized_board*);
  */
 bool tile_can_place(const sized_board*, const tile*, size_t, size_t);
 
+/**
+ * check if tile matches the edges of its neighbours in specified place,
+ * unlike {@code tile_can_place} an empty board has no legal place.
+ * @param [in] board pointer to game board
+ * @param [in] t tile pointer, not NULL
+ * @param [in] y y coordinate of placement
+ * @param [in] x x coordinate of placement
+ * @return if the cell is free, has a neighbour and all neighbours match
+ */
+bool tile_fits(const sized_board*, const tile*, size_t, size_t);
+
 /**
  * rotation in which tile can be placed in the cell
  * @param [in] board
@@ -96,6 +132,8 @@ void tile_place(tile**, tile*);
 
 /**
  * assign tile pointers to board array based on specified file
+ * a file with a header is read at once and parsed row by row, rows and columns
+ * past the dimensions of the header are an error
  * @param [in] filename board file name
  * @param [in, out] board game board
  * @return success of operation
@@ -109,11 +147,11 @@ bool board_parse(const char*, sized_board*);
 void board_print(const sized_board*);
 
 /**
- * prints the board with x on empty cells on which tile specified could be placed.
+ * prints the board with x on the cells of the moves, see {@code getMovesForTile}.
  * @param [in] board game board pointer
- * @param [in] t tile pointer
+ * @param [in] moves cells to mark in board order, may be NULL
  */
-void board_print_legal_moves(const sized_board*, tile*);
+void board_print_legal_moves(const sized_board*, const move_buffer*);
 
 /**
  * write board to file.
@@ -123,6 +161,16 @@ void board_print_legal_moves(const sized_board*, tile*);
  */
 bool board_write(const sized_board*, const char*);
 
+/**
+ * write board to file with a header line.
+ * @param [in] board tile pointer array portraying board
+ * @param [in] filename board file name
+ * @param [in] row game row of the top left cell
+ * @param [in] column game column of the top left cell
+ * @return success of operation
+ */
+bool board_write_header(const sized_board*, const char*, long, long);
+
 /**
  * copy tiles from board src to board dest with offset h height and w width,
  * if dest board had allocated tiles they are not free - memory leak.
@@ -167,6 +215,14 @@ void board_resize(size_t, sized_board*);
 */
 bool board_tileHasNeighbour(const sized_board* board, size_t i, size_t j);
 
+/**
+* counts the empty rows above and the empty columns left of the tiles, what {@code board_trim} removes there.
+* @param [in] board game board
+* @param [out] rows empty rows at the top
+* @param [out] columns empty columns at the left
+*/
+void board_leading_empty(const sized_board* board, size_t* rows, size_t* columns);
+
 void board_trim(sized_board* board);
 
 #endif
@@ -1,19 +1,232 @@
 #include "calculator.h"
+#include "tile_tables.h"
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 static int __completionToStatus(bool isCompleted) {
     if (isCompleted) return 1;
     else return -1;
 }
 
+// scoring unit of a tile: a castle group, a road or a temple, with the points it got
+struct score_unit {
+    uint32_t side;          // side in the region, cell * 4 + direction, unused for temples
+    feature type;
+    int row, column;
+    bool completed;
+    int shields;
+    int points;
+};
+
+void scorer_init(scorer* s) {
+    s->stack = NULL;
+    s->size = 0;
+    s->capacity = 0;
+    s->parent = NULL;
+    s->slots = NULL;
+    s->sides = 0;
+    s->units = NULL;
+    s->unitCount = 0;
+    s->unitCapacity = 0;
+    occupancy_init(&s->occupied);
+    occupancy_init(&s->temples);
+    s->status = NULL;
+    s->statusCapacity = 0;
+    s->columns = 0;
+    s->templeCounts = NULL;
+    s->cells = NULL;
+}
+
+void scorer_reserve(scorer* s, size_t capacity) {
+    if (capacity > s->capacity) {
+        s->capacity = capacity;
+        s->stack = realloc(s->stack, s->capacity * sizeof(side_ref));
+    }
+}
+
+void scorer_setTemples(scorer* s, const temple_tracker* temples) {
+    s->templeCounts = temples;
+}
+
+void scorer_setCells(scorer* s, const morton_board* cells) {
+    s->cells = cells;
+}
+
+void scorer_free(scorer* s) {
+    free(s->stack);
+    free(s->parent);
+    free(s->slots);
+    free(s->units);
+    free(s->status);
+    occupancy_free(&s->occupied);
+    occupancy_free(&s->temples);
+    scorer_init(s);
+}
+
+void score_detailed_init(score_detailed* d, bool regions) {
+    *d = (score_detailed){ 0, 0, 0, 0, NULL, 0, 0, regions };
+}
+
+void score_detailed_free(score_detailed* d) {
+    free(d->regions);
+    score_detailed_init(d, d->withRegions);
+}
+
+// index of a cell in the side arrays of the pass, Z-order when the tiles come from a copy in that order
+static size_t scorer_cell(const scorer* s, size_t i, size_t j) {
+    return s->cells ? morton_index(i, j) : i * s->columns + j;
+}
+
+// tile a walk steps on, the rows of the board stay as they are for the scan in board order
+static tile* scorer_tile(const scorer* s, board_t board, int i, int j) {
+    return s->cells ? morton_at(s->cells, (size_t)i, (size_t)j) : board[i][j];
+}
+
+static uint32_t side_find(scorer* s, uint32_t x) {
+    while (s->parent[x] != x) {
+        s->parent[x] = s->parent[s->parent[x]];
+        x = s->parent[x];
+    }
+    return x;
+}
+
+static void side_join(scorer* s, uint32_t a, uint32_t b) {
+    a = side_find(s, a);
+    b = side_find(s, b);
+    if (a != b) s->parent[b] = a;
+}
+
+// joins the castle and road sides of a tile with each other and with the tiles north and west of it,
+// the tiles south and east do the same when the scan reaches them
+static void regions_addTile(scorer* s, board_t board, size_t i, size_t j, const tile_info* info) {
+    uint32_t base = (uint32_t)(scorer_cell(s, i, j) * 4);
+    for (uint32_t d = 0; d < 4; d++) {
+        s->parent[base + d] = base + d;
+    }
+    if (info->castleGroupSize > 1) {
+        for (size_t k = 1; k < info->segments[CASTLE]; k++) {
+            side_join(s, base + info->sides[CASTLE][0], base + info->sides[CASTLE][k]);
+        }
+    }
+    if (info->segments[ROAD] == 2 && !info->roadEnds) {
+        side_join(s, base + info->sides[ROAD][0], base + info->sides[ROAD][1]);
+    }
+    element north = tile_getSideElement(board[i][j], NORTH), west = tile_getSideElement(board[i][j], WEST);
+    if (i > 0 && board[i - 1][j] && north != FIELD && tile_getSideElement(board[i - 1][j], SOUTH) == north) {
+        side_join(s, base + NORTH, (uint32_t)(scorer_cell(s, i - 1, j) * 4 + SOUTH));
+    }
+    if (j > 0 && board[i][j - 1] && west != FIELD && tile_getSideElement(board[i][j - 1], EAST) == west) {
+        side_join(s, base + WEST, (uint32_t)(scorer_cell(s, i, j - 1) * 4 + EAST));
+    }
+}
+
+static void regions_addUnit(scorer* s, struct score_unit unit) {
+    if (s->unitCount == s->unitCapacity) {
+        s->unitCapacity = s->unitCapacity ? s->unitCapacity * 2 : 64;
+        s->units = realloc(s->units, s->unitCapacity * sizeof(struct score_unit));
+    }
+    s->units[s->unitCount++] = unit;
+}
+
+// gathers the units by region, units come in board order so a tile's units are next to each other
+static void regions_collect(scorer* s, score_detailed* out) {
+    const uint32_t none = UINT32_MAX;
+    for (size_t k = 0; k < s->unitCount; k++) {
+        if (s->units[k].type != FEATURE_TEMPLE) s->slots[side_find(s, s->units[k].side)] = none;
+    }
+    out->regionCount = 0;
+    for (size_t k = 0; k < s->unitCount; k++) {
+        struct score_unit* u = &s->units[k];
+        uint32_t root = u->type == FEATURE_TEMPLE ? none : side_find(s, u->side);
+        score_region* r;
+        if (root == none || s->slots[root] == none) {
+            if (out->regionCount == out->regionCapacity) {
+                out->regionCapacity = out->regionCapacity ? out->regionCapacity * 2 : 64;
+                out->regions = realloc(out->regions, out->regionCapacity * sizeof(score_region));
+            }
+            r = &out->regions[out->regionCount];
+            *r = (score_region){ u->type, u->row, u->column, 0, u->completed, 0, 0 };
+            if (root != none) s->slots[root] = (uint32_t)out->regionCount;
+            out->regionCount++;
+        } else {
+            r = &out->regions[s->slots[root]];
+        }
+        // a temple's tiles are the occupied cells around it, counted in its points
+        if (u->type == FEATURE_TEMPLE) {
+            r->tiles = (size_t)u->points;
+        } else if (r->tiles == 0 || k == 0 || s->units[k - 1].row != u->row || s->units[k - 1].column != u->column
+                   || side_find(s, s->units[k - 1].side) != root) {
+            r->tiles++;
+        }
+        r->shields += u->shields;
+        r->points += u->points;
+    }
+}
+
+// completion of a side in the current pass: -1 open, 1 completed, 0 not visited yet
+static int8_t* scorer_status(scorer* s, int i, int j, direction dir) {
+    return &s->status[scorer_cell(s, (size_t)i, (size_t)j) * 4 + dir];
+}
+
+static void scorer_push(scorer* s, int i, int j, direction dir) {
+    if (s->size == s->capacity) {
+        s->capacity = s->capacity ? s->capacity * 2 : 64;
+        s->stack = realloc(s->stack, s->capacity * sizeof(side_ref));
+    }
+    s->stack[s->size++] = (side_ref){ i, j, dir };
+}
+
+static bool scorer_hasSide(const scorer* s, int i, int j, direction dir) {
+    for (size_t k = 0; k < s->size; k++) {
+        if (s->stack[k].row == i && s->stack[k].column == j && s->stack[k].side == dir) return true;
+    }
+    return false;
+}
+
 int score(sized_board* board) {
+    scorer s;
+    scorer_init(&s);
+    int result = scorer_score(&s, board);
+    scorer_free(&s);
+    return result;
+}
+
+int scorer_score(scorer* s, sized_board* board) {
+    score_detailed d;
+    score_detailed_init(&d, false);
+    scorer_scoreDetailed(s, board, &d);
+    return d.total;
+}
+
+void scorer_scoreDetailed(scorer* s, sized_board* board, score_detailed* out) {
     int score = 0, RS = 0, CS = 0, TS = 0;
 
     board_t tiles = board->tiles;
     size_t rows = board->size, columns = board->size;
 
+    // Z-order leaves gaps up to the rounded up side, the side arrays cover them
+    size_t cells = s->cells ? s->cells->side * s->cells->side : rows * columns;
+    bool regions = out->withRegions;
+    if (regions && cells * 4 > s->sides) {
+        s->sides = cells * 4;
+        s->parent = realloc(s->parent, s->sides * sizeof(uint32_t));
+        s->slots = realloc(s->slots, s->sides * sizeof(uint32_t));
+    }
+    if (cells * 4 > s->statusCapacity) {
+        s->statusCapacity = cells * 4;
+        s->status = realloc(s->status, s->statusCapacity);
+    }
+    memset(s->status, 0, cells * 4);
+    s->columns = columns;
+    s->unitCount = 0;
+    const temple_tracker* counts = s->templeCounts;
+    if (!counts) {
+        occupancy_reset(&s->occupied, board->size);
+        occupancy_reset(&s->temples, board->size);
+    }
+
     for (size_t i = 0; i < rows; i++) {
         for (size_t j = 0; j < columns; j++) {
 
@@ -21,72 +234,59 @@ int score(sized_board* board) {
 
             if (!tile_isEmpty(t)) {
 
-                //1st Criteria: Castle
-                if (tile_hasCastle(t)) {
-
-                    int castleScore = 0;
+                const tile_info* info = tile_info_of(t);
+                if (!counts) {
+                    occupancy_set(&s->occupied, i, j);
+                }
+                uint32_t base = (uint32_t)(scorer_cell(s, i, j) * 4);
+                if (regions) {
+                    regions_addTile(s, tiles, i, j, info);
+                }
 
-                    if (tile_hasShield(t)) {
-                        castleScore++;
-                    }
+                //1st Criteria: Castle
+                // every castle of the tile gives 1 point, 2 if it is completed
+                if (info->castleGroups) {
+                    int castleScore = info->castleBonus;
+                    const uint8_t* sides = info->sides[CASTLE];
 
-                    size_t castleSegments = tile_numOfSegments(t, CASTLE);
-                    direction* sides = tile_getSegments(t, CASTLE, castleSegments);
-                    if (castleSegments == 1) {
-                        if (castleCompleted(tiles, rows, columns, i, j, sides[0])) {
-                            castleScore += 2;
-                        }
-                        else {
-                            castleScore += 1;
-                        }
-                    }
-                    //SPECIAL CASE
-                    // when castleSegments==2 - there can be 2 cities: each segment then should be calculated individually
-                    else if (castleSegments == 2 && tile_getCenter(t) != CITY) {
-                        for (size_t k = 0; k < castleSegments; k++) {
-                            if (castleCompleted(tiles, rows, columns, i, j, sides[k])) {
-                                castleScore += 2;
-                            }
-                            else {
-                                castleScore += 1;
-                            }
-                        }
-                    }
-                    else {
+                    for (size_t g = 0; g < info->castleGroups; g++) {
+                        const uint8_t* group = sides + g * info->castleGroupSize;
                         bool completed = true;
-                        for (size_t k = 0; k < castleSegments; k++) {
-                            completed &= castleCompleted(tiles, rows, columns, i, j, sides[k]);
-                            if (!completed) break; ///
+                        for (size_t k = 0; k < info->castleGroupSize && completed; k++) {
+                            completed = castleCompleted(s, tiles, rows, columns, i, j, group[k]);
                         }
-
-                        if (completed) {
-                            castleScore += 2;
-                        }
-                        else {
-                            castleScore += 1;
+                        castleScore += 1 + completed;
+                        if (regions) {
+                            // the shield goes to the first castle of the tile
+                            int shields = g == 0 ? info->castleBonus : 0;
+                            regions_addUnit(s, (struct score_unit){ base + group[0], FEATURE_CASTLE, (int)i, (int)j,
+                                                                    completed, shields, 1 + completed + shields });
                         }
-
                     }
                     //printf("CITY [%i][%i]: %i\n", i, j, cityScore);
                     score += castleScore;
                     CS += castleScore;
-                    tile_freeSegments(&sides);
                 }
                 // 2nd Criteria: Road
-                if (tile_hasRoad(t)) {
-                    size_t roadSegments = tile_numOfSegments(t, ROAD);
-                    direction* sides = tile_getSegments(t, ROAD, roadSegments);
+                if (info->segments[ROAD]) {
+                    size_t roadSegments = info->segments[ROAD];
                     int roadScore = 0;
 
                     if(roadSegments == 2) {
-                        roadScore += roadScoreForTwo(tiles,rows,columns,i,j, sides);
+                        direction sides[2] = { info->sides[ROAD][0], info->sides[ROAD][1] };
+                        int points = roadScoreForTwo(s, tiles,rows,columns,i,j, sides);
+                        roadScore += points;
+                        if (regions) {
+                            regions_addUnit(s, (struct score_unit){ base + sides[0], FEATURE_ROAD, (int)i, (int)j,
+                                                                    points == 2, 0, points });
+                        }
                     } else {
                         for (size_t k = 0; k < roadSegments; k++) {
-                            if (roadCompleted(tiles, rows, columns, i, j, sides[k])) {
-                                roadScore += 2;
-                            }
-                            else {
-                                roadScore += 1;
+                            bool completed = roadCompleted(s, tiles, rows, columns, i, j, info->sides[ROAD][k]);
+                            roadScore += 1 + completed;
+                            if (regions) {
+                                regions_addUnit(s, (struct score_unit){ base + info->sides[ROAD][k], FEATURE_ROAD, (int)i, (int)j,
+                                                                        completed, 0, 1 + completed });
                             }
                         }
                     }
@@ -94,40 +294,49 @@ int score(sized_board* board) {
                     //printf("ROAD [%i][%i]: %i\n", i, j, roadScore);
                     score += roadScore;
                     RS += roadScore;
-                    tile_freeSegments(&sides);
                 }
 
                 // 3rd Criteria: Chapel
-                if (tile_hasTemple(t)) {
-                    int templeScore = 0;
-                    templeScore += (1 + tile_numOfNeighbours(tiles, rows, columns, i, j));
-                    score += templeScore;
-                    TS += templeScore;
+                // counted after the scan, the rows below are not marked yet
+                if (info->temple) {
+                    if (!counts) {
+                        occupancy_set(&s->temples, i, j);
+                    }
+                    if (regions) {
+                        regions_addUnit(s, (struct score_unit){ 0, FEATURE_TEMPLE, (int)i, (int)j, false, 0, 0 });
+                    }
                 }
             }
         }
     }
 
-    // clear all incompleted side statuses - in further executions this status may be updated, so it can't be constant
-    for (size_t i = 0; i < rows; i++) {
-        for (size_t j = 0; j < columns; j++) {
-            tile* t = tiles[i][j];
-            if (!tile_isEmpty(t)) {
-                for(int k = 0; k < 4; k++) {
-                        tile_setSideCompletion(t,k,0);   
-                }
+    // every temple scores 1 plus its occupied neighbours, summed for all temples at once
+    TS = counts ? counts->score : occupancy_templeScore(&s->occupied, &s->temples);
+    score += TS;
+    if (regions) {
+        for (size_t k = 0; k < s->unitCount; k++) {
+            struct score_unit* u = &s->units[k];
+            if (u->type == FEATURE_TEMPLE) {
+                int neighbours = counts ? temples_occupiedAround(counts, (size_t)u->row, (size_t)u->column)
+                                        : occupancy_neighbours(&s->occupied, (size_t)u->row, (size_t)u->column);
+                u->completed = neighbours == 8;
+                u->points = 1 + neighbours;
             }
         }
     }
-    
-    return score;
-}
 
+    out->castle = CS;
+    out->road = RS;
+    out->temple = TS;
+    out->total = score;
+    if (regions) {
+        regions_collect(s, out);
+    }
+}
 
-bool castleCompleted(board_t board, int rows, int columns, int i, int j, direction dir) {
-    tile* t = board[i][j];
 
-    int status = side_isCompleted(tile_getSide(t, dir));
+bool castleCompleted(scorer* s, board_t board, int rows, int columns, int i, int j, direction dir) {
+    int status = *scorer_status(s, i, j, dir);
     switch (status) {
     case -1: // side was visited and assigned as an uncompleted
         return false;
@@ -141,65 +350,56 @@ bool castleCompleted(board_t board, int rows, int columns, int i, int j, directi
     int in = i, jn = j;
     if (dir == NORTH) {
         if (i <= 0) {
-            tile_setSideCompletion(t, dir, -1);
+            *scorer_status(s, i, j, dir) = -1;
             return false;
         }
         in = i - 1;
     }
     else if (dir == EAST) {
         if (j >= columns - 1) {
-            tile_setSideCompletion(t, dir, -1);
+            *scorer_status(s, i, j, dir) = -1;
             return false;
         }
         jn = j + 1;
     }
     else if (dir == SOUTH) {
         if (i >= rows - 1) {
-            tile_setSideCompletion(t, dir, -1);
+            *scorer_status(s, i, j, dir) = -1;
             return false;
         }
         in = i + 1;
     }
     else if (dir == WEST) {
         if (j <= 0) {
-            tile_setSideCompletion(t, dir, -1);
+            *scorer_status(s, i, j, dir) = -1;
             return false;
         }
         jn = j - 1;
     }
 
-    // list will contain the mentions of all visited city sides in this turn
-    List* list = List_new();
-    // add current tile to a list of visited files
-    List_addLast(list,point_new(i,j,dir));
+    // stack will contain the mentions of all visited city sides in this turn
+    s->size = 0;
+    // add current tile to a stack of visited files
+    scorer_push(s, i, j, dir);
     // checking if a tile is a part of completed castle
-    bool isCompl = tile_castleCompleted(board, rows, columns, in, jn, dir, list);
+    bool isCompl = tile_castleCompleted(s, board, rows, columns, in, jn, dir);
     // obtaining the index of completion depending on the status of completion
     int res = __completionToStatus(isCompl);
-    // obtaining the size of a list of visited sides
-    int size = List_getSize(list);
-
-
-    for (int k = 0; k < size; k++) {
-        point* p = List_getPoint(list, k);
-        tile* self = board[point_getRow(p)][point_getColumn(p)];
-        // assigning the index of completion to the visited side
-        tile_setSideCompletion(self, point_getSide(p), res);
-    }
 
-    List_free(&list);
+    // assigning the index of completion to the visited sides
+    board_setStatuses(s, res);
     return isCompl;
 }
 
-bool tile_castleCompleted(board_t board, int rows, int columns, int i, int j, direction dir, List* stack) {
-    tile* t = board[i][j];
+bool tile_castleCompleted(scorer* s, board_t board, int rows, int columns, int i, int j, direction dir) {
+    tile* t = scorer_tile(s, board, i, j);
 
     if (tile_isEmpty(t)) { // if tile is free(empty) - means the side of a calling tile is open & city is not completed
         return false;
     }
 
     // if the status of the side is already stated -> no use of further investigation
-    switch (tile_getSideCompletion(t, direction_getOpposite(dir))) {
+    switch (*scorer_status(s, i, j, direction_getOpposite(dir))) {
     case -1:
         return false;
     case 1:
@@ -207,23 +407,19 @@ bool tile_castleCompleted(board_t board, int rows, int columns, int i, int j, di
     }
 
     // adding a tile to a list of visited tiles (later every side of every tile from list will have the indicator of true/false completion
-    List_addLast(stack, point_new(i, j, direction_getOpposite(dir)));
+    scorer_push(s, i, j, direction_getOpposite(dir));
 
     // get number of city segments of a tile
-    size_t numOfCastles = tile_numOfSegments(t, CASTLE);
+    const tile_info* info = tile_info_of(t);
+    const uint8_t* sides = info->sides[CASTLE];
+    size_t numOfCastles = info->segments[CASTLE];
 
-    // simpliest case: 1 city tile automatically means that this is border
-    if (numOfCastles == 1) {
-        return true;
-    }
-
-    // 2 disjoint city segments 
-    if (numOfCastles == 2 && tile_getCenter(t) != CITY) {
+    // simpliest case: 1 city tile or 2 disjoint city segments automatically means that this is border
+    if (info->castleGroupSize == 1) {
         return true;
     }
 
     // Cases when we have more than 1 side with castles
-    direction* sides = tile_getSegments(t, CASTLE, numOfCastles);
     bool isCompl = true;
     bool compl = true;
     int in, jn;
@@ -261,10 +457,9 @@ bool tile_castleCompleted(board_t board, int rows, int columns, int i, int j, di
         //  1) We've already visited the tile (avoid infinite looping)
         //  2) We've came from this tile (can be recognised when dir(previous direction of movements) is opposite to sides[k] (new direction of movement)
         //  3) We are heading to the initial tile's unvisited side
-        if (compl && !List_hasPoint(stack, in, jn, direction_getOpposite(sides[k])) && !direction_areOpposite(dir, sides[k]) && compl /*&& !Point_isEqual(List_getPoint(stack,0),in,jn)*/) {
-            List_addLast(stack, point_new(i, j, sides[k]));
-            //printf("%i,%i - %i\n", i, j, sides[k]);
-            compl = tile_castleCompleted(board, rows, columns, in, jn, sides[k], stack);
+        if (compl && !scorer_hasSide(s, in, jn, direction_getOpposite(sides[k])) && !direction_areOpposite(dir, sides[k])) {
+            scorer_push(s, i, j, sides[k]);
+            compl = tile_castleCompleted(s, board, rows, columns, in, jn, sides[k]);
         }
 
         // update the overall status: isCompl by default is true => 
@@ -280,23 +475,28 @@ bool tile_castleCompleted(board_t board, int rows, int columns, int i, int j, di
     return isCompl;
 }
 
-bool tile_roadCompleted(board_t board, int rows, int columns, int i, int j, direction dir, List* stack) {
-    tile* t = board[i][j];
+bool tile_roadCompleted(scorer* s, board_t board, int rows, int columns, int i, int j, direction dir) {
+    tile* t = scorer_tile(s, board, i, j);
 
     if (tile_isEmpty(t)) return false;
 
     // if the status of the side is already stated -> no use of further investigation
-    switch (tile_getSideCompletion(t, direction_getOpposite(dir))) {
+    switch (*scorer_status(s, i, j, direction_getOpposite(dir))) {
     case -1:
         return false;
     case 1:
         return true;
     }
 
+    // road came back to a side visited in this walk: it is a closed loop
+    if (scorer_hasSide(s, i, j, direction_getOpposite(dir))) {
+        return true;
+    }
+
     // adding a tile to a list of visited tiles (later every side of every tile from list will have the indicator of true/false completion
-    List_addLast(stack, point_new(i, j, direction_getOpposite(dir)));
+    scorer_push(s, i, j, direction_getOpposite(dir));
 
-    if (tile_hasCrossroads(t) || tile_hasTemple(t) || tile_numOfSegments(t,ROAD)==1) return true;
+    if (tile_info_of(t)->roadEnds) return true;
 
     int in = i, jn = j;
 
@@ -315,27 +515,25 @@ bool tile_roadCompleted(board_t board, int rows, int columns, int i, int j, dire
         return false;
     }
 
-    List_addLast(stack, point_new(i,j,dir));
-    return tile_roadCompleted(board,rows,columns, in, jn, dir, stack);
+    scorer_push(s, i, j, dir);
+    return tile_roadCompleted(s, board, rows, columns, in, jn, dir);
 }
 
 
-int roadScoreForTwo(board_t board, int rows, int columns,int i, int j, direction* sides) {
-    tile* t = board[i][j];
-    
-    switch(side_isCompleted(tile_getSide(t,sides[0]))*side_isCompleted(tile_getSide(t,sides[1]))) {
+int roadScoreForTwo(scorer* s, board_t board, int rows, int columns, int i, int j, const direction* sides) {
+    switch(*scorer_status(s, i, j, sides[0]) * *scorer_status(s, i, j, sides[1])) {
         case 1:
             return 2;
         case -1:
             return 1;
     }
         
-    List* path = List_new();
+    s->size = 0;
     bool isCompl = true;
     int in, jn;
 
     for(size_t k = 0; k < 2; k++) {
-        List_addLast(path,point_new(i,j,sides[k]));
+        scorer_push(s, i, j, sides[k]);
         in = i, jn = j;
     
         if (sides[k] == NORTH) {
@@ -367,12 +565,12 @@ int roadScoreForTwo(board_t board, int rows, int columns,int i, int j, direction
             jn = j - 1;
         }
 
-        isCompl &= tile_roadCompleted(board,rows,columns,in,jn,sides[k],path);
+        isCompl &= tile_roadCompleted(s, board, rows, columns, in, jn, sides[k]);
     }
     
     int res = __completionToStatus(isCompl);
 
-    board_setStatuses(board,path,res);
+    board_setStatuses(s, res);
 
     switch(res) {
         case 1: return 2;
@@ -381,28 +579,16 @@ int roadScoreForTwo(board_t board, int rows, int columns,int i, int j, direction
     }
 }
 
-void board_setStatuses(board_t board, List* list, int res) {
-    if(!list) return;
-    
-    ListNode* node = List_getNodeAt(list,0);
-    ListNode* next = NULL;
-    while(node != NULL) {
-        point* p = ListNode_getPoint(node);
-        tile* self = board[point_getRow(p)][point_getColumn(p)];
-        tile_setSideCompletion(self, point_getSide(p), res);
-        
-        next = ListNode_getNext(node);
-        ListNode_free(&node);
-        node = next;
+void board_setStatuses(scorer* s, int res) {
+    for (size_t k = 0; k < s->size; k++) {
+        side_ref* p = &s->stack[k];
+        *scorer_status(s, p->row, p->column, p->side) = (int8_t)res;
     }
-
-    free(list);
+    s->size = 0;
 }
 
-bool roadCompleted(board_t board, int rows, int columns, int i, int j, direction dir) {
-    tile* t = board[i][j];
-
-    int status = side_isCompleted(tile_getSide(t,dir));
+bool roadCompleted(scorer* s, board_t board, int rows, int columns, int i, int j, direction dir) {
+    int status = *scorer_status(s, i, j, dir);
 
     switch (status) {
     case -1: // side was visited and assigned as an uncompleted
@@ -418,43 +604,43 @@ bool roadCompleted(board_t board, int rows, int columns, int i, int j, direction
     
     if (dir == NORTH) {
         if (i <= 0) {
-            tile_setSideCompletion(t, dir, -1);
+            *scorer_status(s, i, j, dir) = -1;
             return false;
         }
         in = i - 1;
     }
     else if (dir == EAST) {
         if (j >= columns - 1) {
-            tile_setSideCompletion(t, dir, -1);
+            *scorer_status(s, i, j, dir) = -1;
             return false;
         }
         jn = j + 1;
     }
     else if (dir == SOUTH) {
         if (i >= rows - 1) {
-            tile_setSideCompletion(t, dir, -1);
+            *scorer_status(s, i, j, dir) = -1;
             return false;
         }
         in = i + 1;
     }
     else if (dir == WEST) {
         if (j <= 0) {
-            tile_setSideCompletion(t, dir, -1);
+            *scorer_status(s, i, j, dir) = -1;
             return false;
         }
         jn = j - 1;
     }
 
-    // list will contain the mentions of all visited city sides in this turn
-    List* list = List_new();
-    // add current tile to a list of visited files
-    List_addLast(list, point_new(i,j,dir));
-    // checking if a tile is a part of completed castle
-    bool isCompl = tile_roadCompleted(board,rows,columns, in, jn, dir, list);
+    // stack will contain the mentions of all visited road sides in this turn
+    s->size = 0;
+    // add current tile to a stack of visited files
+    scorer_push(s, i, j, dir);
+    // checking if a tile is a part of completed road
+    bool isCompl = tile_roadCompleted(s, board, rows, columns, in, jn, dir);
     // obtaining the index of completion depending on the status of completion
     int res = __completionToStatus(isCompl);
 
-    board_setStatuses(board,list,res);
+    board_setStatuses(s, res);
 
     return isCompl;
 }
@@ -4,25 +4,171 @@
 #include "tile.h"
 #include "point.h"
 #include "board.h"
+#include "morton.h"
+#include "occupancy.h"
+#include "temples.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 
+/**
+* side of a tile on the board visited by a castle or road walk
+*/
+typedef struct {
+    int row;
+    int column;
+    direction side;
+} side_ref;
+
+/**
+* scoring context: keeps the stack of visited sides between calls,
+* so once it has grown scoring a board does not allocate.
+* the completion of the sides is kept here as well, scoring never writes to the tiles,
+* so boards sharing tiles can be scored at the same time with a scorer each
+*/
+typedef struct {
+    side_ref* stack;
+    size_t size;
+    size_t capacity;
+    uint32_t* parent;           // union-find over tile sides (cell * 4 + direction), only used for regions
+    uint32_t* slots;            // region of a side root while collecting
+    size_t sides;               // capacity of parent and slots
+    struct score_unit* units;   // scoring units of the current pass in board order
+    size_t unitCount;
+    size_t unitCapacity;
+    occupancy occupied;         // tiles of the current pass
+    occupancy temples;          // temples of the current pass
+    int8_t* status;             // completion of every side of the pass (cell * 4 + direction), 0 unknown
+    size_t statusCapacity;
+    size_t columns;             // columns of the board of the current pass
+    const temple_tracker* templeCounts; // temple points kept up to date by the caller, NULL to count them
+    const morton_board* cells;  // Z-ordered tiles kept up to date by the caller, NULL to read the rows
+} scorer;
+
+/**
+* feature a region of the board scores for
+*/
+typedef enum {
+    FEATURE_CASTLE,
+    FEATURE_ROAD,
+    FEATURE_TEMPLE
+} feature;
+
+/**
+* castle, road or temple of the board with the points it scored.
+* a castle or road is every connected side of that element, a temple is its own region
+*/
+typedef struct {
+    feature type;
+    int row;            // first tile of the region in row-major order
+    int column;
+    size_t tiles;       // tiles the region covers, for a temple the temple and its neighbours
+    bool completed;
+    int shields;
+    int points;
+} score_region;
+
+/**
+* score of a board split by feature, optionally by region.
+* the regions array is owned by the struct and reused between calls
+*/
+typedef struct {
+    int castle;
+    int road;
+    int temple;
+    int total;
+    score_region* regions;
+    size_t regionCount;
+    size_t regionCapacity;
+    bool withRegions;   // fill regions, otherwise only the subtotals
+} score_detailed;
+
+/**
+* initializes an empty breakdown
+* @param [out] breakdown to initialize
+* @param [in] whether scoring should list the regions
+*/
+void score_detailed_init(score_detailed* d, bool regions);
+
+/**
+* frees the regions of a breakdown
+* @param [in, out] breakdown to free
+*/
+void score_detailed_free(score_detailed* d);
+
+/**
+* initializes an empty scorer
+* @param [out] scorer to initialize
+*/
+void scorer_init(scorer* s);
+
+/**
+* grows the stack up front so later scoring does not allocate
+* @param [in, out] scorer
+* @param [in] capacity amount of sides the stack can hold
+*/
+void scorer_reserve(scorer* s, size_t capacity);
+
+/**
+* takes the temple points of the following passes from a tracker instead of counting them.
+* the tracker has to follow every change of the scored board
+* @param [in, out] scorer
+* @param [in] tracker of the board, NULL to count the temples again
+*/
+void scorer_setTemples(scorer* s, const temple_tracker* temples);
+
+/**
+* takes the tiles the castle and road walks visit from a Z-ordered copy of the board instead of its rows,
+* the completion of the sides is kept in the same order. the copy has to follow every change of the scored board
+* @param [in, out] scorer
+* @param [in] cells copy of the board, NULL to read the rows again
+*/
+void scorer_setCells(scorer* s, const morton_board* cells);
+
+/**
+* frees the stack of the scorer
+* @param [in, out] scorer to free
+*/
+void scorer_free(scorer* s);
+
+/**
+* calculates score of the board reusing the scorer's stack
+* @param [in, out] scorer
+* @param [in] game board
+* @return score of the board
+*/
+int scorer_score(scorer* s, sized_board* board);
+
+/**
+* calculates score of the board with subtotals per feature and, when asked for, the regions.
+* it is the same pass as scorer_score, the regions are joined while the tiles are visited
+* @param [in, out] scorer
+* @param [in] game board
+* @param [in, out] breakdown initialized with score_detailed_init
+*/
+void scorer_scoreDetailed(scorer* s, sized_board* board, score_detailed* out);
+
+/**
+* calculates score of the board with a temporary scorer
+* @param [in] game board
+* @return score of the board
+*/
 int score(sized_board* board);
 
-int roadScoreForTwo(board_t board, int rows, int columns,int i, int j, direction* sides);
+int roadScoreForTwo(scorer* s, board_t board, int rows, int columns, int i, int j, const direction* sides);
 
-bool tile_roadCompleted(board_t board, int rows, int columns, int i, int j, direction dir, List* stack);
+bool tile_roadCompleted(scorer* s, board_t board, int rows, int columns, int i, int j, direction dir);
 
-bool roadCompleted(board_t board, int rows, int columns, int i, int j, direction dir);
+bool roadCompleted(scorer* s, board_t board, int rows, int columns, int i, int j, direction dir);
 
-bool tile_castleCompleted(board_t board, int rows, int columns, int i, int j, direction dir, List* stack);
+bool tile_castleCompleted(scorer* s, board_t board, int rows, int columns, int i, int j, direction dir);
 
-bool castleCompleted(board_t board, int rows, int columns, int i, int j, direction dir);
+bool castleCompleted(scorer* s, board_t board, int rows, int columns, int i, int j, direction dir);
 
 int tile_numOfNeighbours(board_t board, int rows, int columns, int i, int j);
 
-void board_setStatuses(board_t board, List* list, int res);
+void board_setStatuses(scorer* s, int res);
 
 #endif
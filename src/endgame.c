@@ -0,0 +1,366 @@
+#include "endgame.h"
+#include "region.h"
+#include "tile_tables.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// time for a search when the move has no deadline
+#define ENDGAME_BUDGET_MS 1000
+// entries of the position table, a power of two
+#define ENDGAME_TABLE_SIZE ((size_t)1 << 16)
+// nodes between two looks at the clock
+#define ENDGAME_CLOCK_NODES 1024
+
+static const int rowStep[4] = { -1, 0, 1, 0 };
+static const int columnStep[4] = { 0, 1, 0, -1 };
+
+typedef struct {
+    uint64_t key;           // 0 for an empty entry
+    int value;              // best final score from the position
+    uint32_t depth;         // tiles the value looked ahead
+    bool exact;             // no line was stopped by the horizon, the value holds for any depth
+    bool upper;             // the search failed low, the value only bounds the score from above
+} endgame_entry;
+
+// tiles of the pile that are the same up to rotation
+typedef struct {
+    size_t tileIndex;       // first tile of the kind in the pile
+    size_t code;            // tile_code of that tile as it lies in the pile
+    size_t left;            // tiles of the kind not placed yet
+    uint64_t hash;          // added to the pile hash once per tile left
+    int gain;               // most points one tile of the kind can add by itself
+} endgame_kind;
+
+typedef struct {
+    uint32_t units;
+} endgame_region;
+
+typedef struct {
+    size_t cell;            // row * columns + column on the tracker
+    size_t tileIndex;
+    size_t rotation;
+} endgame_move;
+
+typedef struct {
+    region_tracker r;
+    size_t margin;          // offset of the board on the tracker
+    size_t boardSize;
+    endgame_kind* kinds;
+    size_t kindCount;
+    size_t* byGain;         // kinds with the highest gain first
+    endgame_region* regions; // scratch for the bound, one per side of the tracker
+    // empty cells next to a tile, placed cells stay listed until their placement is undone
+    size_t* cells;
+    size_t cellCount;
+    bool* listed;
+    endgame_entry* table;
+    uint64_t boardHash;
+    uint64_t pileHash;
+    size_t tilesLeft;
+    size_t nodes;
+    size_t cuts;            // positions left out because their bound could not beat the best line
+    double deadline;
+    bool stop;
+} endgame_solver;
+
+static uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static void listCell(endgame_solver* es, size_t row, size_t column) {
+    size_t cell = row * es->r.columns + column;
+    if(!es->listed[cell] && !es->r.cells[cell]) {
+        es->listed[cell] = true;
+        es->cells[es->cellCount++] = cell;
+    }
+}
+
+static void listNeighbours(endgame_solver* es, size_t row, size_t column) {
+    for(int d = 0; d < 4; d++) {
+        if((rowStep[d] < 0 && row == 0) || (columnStep[d] < 0 && column == 0)
+                || (rowStep[d] > 0 && row + 1 >= es->r.rows) || (columnStep[d] > 0 && column + 1 >= es->r.columns)) {
+            continue;
+        }
+        listCell(es, (size_t)((int)row + rowStep[d]), (size_t)((int)column + columnStep[d]));
+    }
+}
+
+// the root may only answer with cells of the board it was given
+static bool onBoard(const endgame_solver* es, size_t cell) {
+    size_t row = cell / es->r.columns, column = cell % es->r.columns;
+    return row >= es->margin && row < es->margin + es->boardSize
+        && column >= es->margin && column < es->margin + es->boardSize;
+}
+
+// open regions by units scoring 1 point, most first
+static int region_compare(const void* a, const void* b) {
+    const endgame_region* x = a;
+    const endgame_region* y = b;
+    return x->units > y->units ? -1 : x->units < y->units;
+}
+
+// points the open regions can gain with tiles placed: the walks of score() give a unit of a region
+// its second point at best once a tile joins the region, and a tile joins at most 4 of them,
+// so the regions with the most units scoring 1 point are taken up to that many
+static int openBound(endgame_solver* es, size_t tiles) {
+    size_t count = 0;
+    for(uint32_t s = 0; s < es->r.count * 4; s++) {
+        if(es->r.parent[s] == s && es->r.open[s] && es->r.units[s]) {
+            es->regions[count++] = (endgame_region){ es->r.units[s] };
+        }
+    }
+    qsort(es->regions, count, sizeof(endgame_region), region_compare);
+    size_t joined = 4 * tiles;
+    int units = 0;
+    for(size_t k = 0; k < count && k < joined; k++) {
+        units += (int)es->regions[k].units;
+    }
+    return units;
+}
+
+// admissible bound of the final score after placing up to depth more tiles: every unit of an open
+// region scores 2 points, every cell around a temple gets filled and the best tiles left score all their units
+// twice, their shield and a full temple. the regions are only looked at when the quick bound
+// counting all of them is not low enough already
+static int bound(endgame_solver* es, size_t depth, int alpha) {
+    size_t tiles = depth < es->tilesLeft ? depth : es->tilesLeft;
+    int gain = 0;
+    for(size_t k = 0, n = tiles; k < es->kindCount && n; k++) {
+        const endgame_kind* kind = &es->kinds[es->byGain[k]];
+        size_t take = kind->left < n ? kind->left : n;
+        gain += (int)take * kind->gain;
+        n -= take;
+    }
+    int slots = es->r.templeSlots, fillable = 8 * (int)tiles;
+    int most = es->r.score + (slots < fillable ? slots : fillable) + gain;
+    if(most + es->r.openUnits <= alpha) {
+        return most + es->r.openUnits;
+    }
+    return most + openBound(es, tiles);
+}
+
+static int solve(endgame_solver* es, size_t depth, int alpha, bool* exact, endgame_move* best);
+
+// places a tile, solves the position after it and takes the tile back
+static int play(endgame_solver* es, size_t cell, size_t code, size_t depth, int alpha, bool* exact) {
+    size_t mark = region_mark(&es->r), cellCount = es->cellCount;
+    uint64_t boardHash = es->boardHash;
+    size_t row = cell / es->r.columns, column = cell % es->r.columns;
+    region_place(&es->r, row, column, code);
+    es->boardHash ^= mix((uint64_t)cell * TILE_CODES + code);
+    listNeighbours(es, row, column);
+
+    int value = solve(es, depth - 1, alpha, exact, NULL);
+
+    while(es->cellCount > cellCount) {
+        es->listed[es->cells[--es->cellCount]] = false;
+    }
+    es->boardHash = boardHash;
+    region_undo(&es->r, mark);
+    return value;
+}
+
+// best final score reachable from the position looking depth tiles ahead, exact is cleared
+// when a line was stopped by the horizon. a score not above alpha cannot change the choice
+// of a caller, a search failing low only returns a bound of it that is not above alpha either.
+// best gets the first move reaching the score at the root
+static int solve(endgame_solver* es, size_t depth, int alpha, bool* exact, endgame_move* best) {
+    if(++es->nodes % ENDGAME_CLOCK_NODES == 0 && ai_clockMs() >= es->deadline) {
+        es->stop = true;
+    }
+    if(es->stop) {
+        return 0;
+    }
+    if(depth == 0 || es->tilesLeft == 0) {
+        *exact = es->tilesLeft == 0;
+        return es->r.score;
+    }
+
+    uint64_t key = mix(es->boardHash ^ mix(es->pileHash));
+    key += key == 0;
+    endgame_entry* entry = &es->table[key & (ENDGAME_TABLE_SIZE - 1)];
+    if(!best && entry->key == key && (entry->exact || entry->depth == depth)
+            && (!entry->upper || entry->value <= alpha)) {
+        *exact = entry->exact;
+        return entry->value;
+    }
+    // a bound over every tile left holds at the end of the game too, so the cut stays exact.
+    // one stopped by the horizon only covers depth tiles, a deeper search may still beat alpha
+    int most = bound(es, depth, alpha);
+    if(most <= alpha) {
+        es->cuts++;
+        *exact = depth >= es->tilesLeft;
+        return most;
+    }
+
+    int value = -1;
+    bool allExact = true;
+    size_t cellCount = es->cellCount;
+    for(size_t k = 0; k < es->kindCount; k++) {
+        endgame_kind* kind = &es->kinds[k];
+        if(kind->left == 0) continue;
+        kind->left--;
+        es->tilesLeft--;
+        es->pileHash -= kind->hash;
+        size_t code = kind->code;
+        for(size_t rot = 0; rot < tile_infos[kind->code].rotations; rot++, code = tile_infos[code].rotated) {
+            // cells listed by deeper placements are gone again when the loop gets back here
+            for(size_t c = 0; c < cellCount; c++) {
+                size_t cell = es->cells[c];
+                if((best && !onBoard(es, cell))
+                        || !region_fits(&es->r, cell / es->r.columns, cell % es->r.columns, code)) {
+                    continue;
+                }
+                bool lineExact = true;
+                int v = play(es, cell, code, depth, value > alpha ? value : alpha, &lineExact);
+                if(es->stop) {
+                    kind->left++;
+                    es->tilesLeft++;
+                    es->pileHash += kind->hash;
+                    return 0;
+                }
+                allExact &= lineExact;
+                if(v > value) {
+                    value = v;
+                    if(best) {
+                        *best = (endgame_move){ cell, kind->tileIndex, rot };
+                    }
+                }
+            }
+        }
+        kind->left++;
+        es->tilesLeft++;
+        es->pileHash += kind->hash;
+    }
+    // no remaining tile fits anywhere: the game ends here
+    bool upper = value >= 0 && value <= alpha;
+    if(value < 0) {
+        value = es->r.score;
+    }
+
+    *entry = (endgame_entry){ key, value, (uint32_t)depth, allExact, upper };
+    *exact = allExact;
+    return value;
+}
+
+// fills the tracker with the board and groups the pile into kinds, false if the board is empty
+static bool solverInit(endgame_solver* es, const sized_board* board, const sized_tlist* list) {
+    memset(es, 0, sizeof(*es));
+    // one cell more than the pile can reach, so no walk ends at the border of the tracker
+    es->margin = list->size + 1;
+    es->boardSize = board->size;
+    size_t width = board->size + 2 * es->margin;
+    region_init(&es->r, width, width);
+    es->cells = malloc(width * width * sizeof(size_t));
+    es->listed = calloc(width * width, sizeof(bool));
+    es->kinds = malloc(list->size * sizeof(endgame_kind));
+    es->table = calloc(ENDGAME_TABLE_SIZE, sizeof(endgame_entry));
+
+    for(size_t i = 0; i < board->size; i++) {
+        for(size_t j = 0; j < board->size; j++) {
+            if(board->tiles[i][j]) {
+                region_place(&es->r, i + es->margin, j + es->margin, tile_code(board->tiles[i][j]));
+            }
+        }
+    }
+    if(es->r.count == 0) {
+        return false;
+    }
+    for(size_t i = 0; i < width; i++) {
+        for(size_t j = 0; j < width; j++) {
+            if(es->r.cells[i * width + j]) {
+                listNeighbours(es, i, j);
+            }
+        }
+    }
+    region_enableUndo(&es->r);
+
+    // a kind is named by the smallest code of its rotations
+    for(size_t j = 0; j < list->size; j++) {
+        size_t code = tile_code(list->tiles[j]), least = code;
+        for(size_t rot = 1, c = tile_infos[code].rotated; rot < 4; rot++, c = tile_infos[c].rotated) {
+            if(c < least) least = c;
+        }
+        uint64_t hash = mix(least);
+        size_t k = 0;
+        while(k < es->kindCount && es->kinds[k].hash != hash) k++;
+        if(k == es->kindCount) {
+            const tile_info* info = &tile_infos[code];
+            int roads = info->segments[ROAD] == 2 ? 1 : info->segments[ROAD];
+            int gain = 2 * (info->castleGroups + roads) + info->castleBonus + 9 * info->temple;
+            es->kinds[es->kindCount++] = (endgame_kind){ j, code, 0, hash, gain };
+        }
+        es->kinds[k].left++;
+        es->tilesLeft++;
+        es->pileHash += hash;
+    }
+    es->byGain = malloc(es->kindCount * sizeof(size_t));
+    for(size_t k = 0; k < es->kindCount; k++) {
+        size_t at = k;
+        for(; at > 0 && es->kinds[es->byGain[at - 1]].gain < es->kinds[k].gain; at--) {
+            es->byGain[at] = es->byGain[at - 1];
+        }
+        es->byGain[at] = k;
+    }
+    es->regions = malloc((es->r.count + list->size) * 4 * sizeof(endgame_region));
+    return true;
+}
+
+static void solverFree(endgame_solver* es) {
+    region_free(&es->r);
+    free(es->cells);
+    free(es->listed);
+    free(es->kinds);
+    free(es->byGain);
+    free(es->regions);
+    free(es->table);
+}
+
+move* endgame_search(sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats) {
+    if(list->size == 0 || list->size > config->endgameTiles) {
+        return NULL;
+    }
+    double start = ai_clockMs();
+    endgame_solver es;
+    bool solved = false;
+    int rootBound = 0, result = 0;
+    move* m = NULL;
+    if(solverInit(&es, board, list)) {
+        rootBound = bound(&es, list->size, INT_MAX);
+        es.deadline = config->deadline > 0 ? start + (config->deadline - start) / 2 : start + ENDGAME_BUDGET_MS;
+        for(size_t horizon = 1; horizon <= list->size && !solved; horizon++) {
+            endgame_move best = { SIZE_MAX, 0, 0 };
+            bool exact = true;
+            // one more tile never lowers the score, so the last horizon's score is reached again
+            int value = solve(&es, horizon, result - 1, &exact, &best);
+            if(es.stop || best.cell == SIZE_MAX) {
+                break;
+            }
+            if(m == NULL) {
+                m = move_default();
+            }
+            move_set(m, (int)(best.cell / es.r.columns - es.margin), (int)(best.cell % es.r.columns - es.margin),
+                     (int)best.tileIndex, (int)best.rotation, value);
+            solved = exact;
+            result = value;
+        }
+    }
+    if(stats) {
+        stats->endgameSearches++;
+        stats->endgameSolved += solved;
+        stats->endgameNodes += es.nodes;
+        stats->endgameCuts += es.cuts;
+        if(solved) {
+            stats->endgameBoundGap += (size_t)(rootBound - result);
+        }
+        stats->endgameSeconds += (ai_clockMs() - start) / 1e3;
+    }
+    solverFree(&es);
+    return m;
+}
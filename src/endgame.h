@@ -0,0 +1,26 @@
+#ifndef ENDGAME_H
+#define ENDGAME_H
+/** @file endgame.h */
+
+#include "ai.h"
+
+/**
+* Solves the rest of the game exactly once config->endgameTiles or fewer tiles are left.
+* Placements are searched depth first on a region tracker that takes them back with undo,
+* identical tiles in the pile are tried once. Positions met again are looked up in a table
+* keyed by a hash of the placed tiles and a hash of the multiset of remaining tiles.
+* Positions whose admissible score bound cannot beat the best line found so far are cut.
+* The search deepens one tile at a time and values a position at the horizon by its score,
+* so when the budget runs out the deepest finished horizon answers and the amount of tiles
+* solved adapts to the time available. The budget is half of the time left to config->deadline,
+* or ENDGAME_BUDGET_MS without a deadline
+* @param [in] game board
+* @param [in] list with available tiles
+* @param [in] search settings
+* @param [out] searches, solved searches, nodes, cuts, bound gap and time are added, may be NULL
+* @return best move found, NULL if the pile is too big, the board is empty,
+*         there is no move or not even one tile could be looked at in time
+*/
+move* endgame_search(sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats);
+
+#endif
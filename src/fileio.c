@@ -0,0 +1,56 @@
+#include "fileio.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// mode a new file gets from open, the process umask applied to 0666
+static mode_t new_file_mode(void) {
+    mode_t mask = umask(0);
+    umask(mask);
+    return 0666 & ~mask;
+}
+
+static bool write_all(int fd, const char* data, size_t length) {
+    while (length) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+bool fileio_write_atomic(const char* filename, const char* data, size_t length) {
+    size_t nameLength = strlen(filename);
+    char* temp = malloc(nameLength + sizeof(".XXXXXX"));
+    if (!temp) {
+        return false;
+    }
+    memcpy(temp, filename, nameLength);
+    memcpy(temp + nameLength, ".XXXXXX", sizeof(".XXXXXX"));
+
+    int fd = mkstemp(temp);
+    if (fd < 0) {
+        free(temp);
+        return false;
+    }
+    struct stat info;
+    mode_t mode = stat(filename, &info) == 0 ? info.st_mode & 0777 : new_file_mode();
+    bool ok = fchmod(fd, mode) == 0 && write_all(fd, data, length) && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(temp, filename) != 0) {
+        unlink(temp);
+        ok = false;
+    }
+    free(temp);
+    return ok;
+}
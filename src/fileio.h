@@ -0,0 +1,20 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+/** @file fileio.h */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+* replaces a file with the data in one step.
+* the data goes to a temporary file next to it which is renamed over the old one,
+* so a crash leaves either the old or the new file, never a truncated one.
+* the permissions of an existing file are kept
+* @param [in] filename file to replace
+* @param [in] data bytes to write
+* @param [in] length amount of bytes
+* @return success of operation, on failure the old file is untouched
+*/
+bool fileio_write_atomic(const char* filename, const char* data, size_t length);
+
+#endif
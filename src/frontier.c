@@ -0,0 +1,238 @@
+#include "frontier.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NOT_ON_FRONTIER SIZE_MAX
+
+uint8_t frontier_constraintAt(const sized_board* board, size_t row, size_t column) {
+    unsigned key = FRONTIER_OPEN;
+    const tile* n;
+    if (row > 0 && (n = board->tiles[row - 1][column])) {
+        key = (key & ~(3u << (2 * NORTH))) | (unsigned)n->down->type << (2 * NORTH);
+    }
+    if (column + 1 < board->size && (n = board->tiles[row][column + 1])) {
+        key = (key & ~(3u << (2 * EAST))) | (unsigned)n->left->type << (2 * EAST);
+    }
+    if (row + 1 < board->size && (n = board->tiles[row + 1][column])) {
+        key = (key & ~(3u << (2 * SOUTH))) | (unsigned)n->up->type << (2 * SOUTH);
+    }
+    if (column > 0 && (n = board->tiles[row][column - 1])) {
+        key = (key & ~(3u << (2 * WEST))) | (unsigned)n->right->type << (2 * WEST);
+    }
+    return (uint8_t)key;
+}
+
+// true if a tile with the edges fits a cell with the key: equal edges wherever the key is not FRONTIER_ANY
+static bool key_accepts(uint8_t key, uint8_t edges) {
+    unsigned any = (unsigned)(key & (key >> 1)) & 0x55u;
+    return (((unsigned)key ^ edges) & ~(any | any << 1)) == 0;
+}
+
+// a cell with the key joins (delta 1) or leaves (delta -1) the cells of every watched edges it accepts
+static void watched_update(frontier* f, uint8_t key, int delta) {
+    for (size_t w = 0; w < f->watchedCount; w++) {
+        uint8_t edges = f->watched[w];
+        if (key_accepts(key, edges)) {
+            if (delta > 0 && f->fits[edges]++ == 0) {
+                f->placeable++;
+            } else if (delta < 0 && --f->fits[edges] == 0) {
+                f->placeable--;
+            }
+        }
+    }
+}
+
+static void bucket_push(frontier* f, uint8_t key, size_t cell) {
+    frontier_bucket* b = &f->buckets[key];
+    watched_update(f, key, 1);
+    if (b->count == b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 16;
+        b->cells = realloc(b->cells, b->capacity * sizeof(size_t));
+    }
+    f->positions[cell] = b->count;
+    b->cells[b->count++] = cell;
+}
+
+// removes the cell by moving the last one of the bucket in its place
+static void bucket_remove(frontier* f, size_t cell) {
+    frontier_bucket* b = &f->buckets[f->keys[cell]];
+    watched_update(f, f->keys[cell], -1);
+    size_t position = f->positions[cell], last = b->cells[--b->count];
+    if (position != b->count) {
+        b->cells[position] = last;
+        f->positions[last] = position;
+    }
+    f->positions[cell] = NOT_ON_FRONTIER;
+}
+
+// inverse of bucket_remove: the cell that took the position goes back to the end
+static void bucket_insertAt(frontier* f, uint8_t key, size_t cell, size_t position) {
+    frontier_bucket* b = &f->buckets[key];
+    size_t count = b->count;
+    bucket_push(f, key, cell);
+    if (position != count) {
+        size_t moved = b->cells[position];
+        b->cells[count] = moved;
+        f->positions[moved] = count;
+        b->cells[position] = cell;
+        f->positions[cell] = position;
+    }
+}
+
+static void frontier_set(frontier* f, size_t cell, uint8_t key, bool on) {
+    bool was = f->positions[cell] != NOT_ON_FRONTIER;
+    if (was == on && (!on || f->keys[cell] == key)) {
+        return;
+    }
+    if (f->logSize == f->logCapacity) {
+        f->logCapacity = f->logCapacity ? f->logCapacity * 2 : 64;
+        f->log = realloc(f->log, f->logCapacity * sizeof(frontier_change));
+    }
+    f->log[f->logSize++] = (frontier_change){ cell, f->positions[cell], f->keys[cell] };
+
+    if (was) {
+        bucket_remove(f, cell);
+    }
+    f->keys[cell] = key;
+    if (on) {
+        bucket_push(f, key, cell);
+    }
+}
+
+void frontier_init(frontier* f, const sized_board* board) {
+    size_t cells = board->size * board->size;
+    memset(f, 0, sizeof(*f));
+    f->size = board->size;
+    f->keys = malloc(cells);
+    f->positions = malloc(cells * sizeof(size_t));
+    memset(f->keys, FRONTIER_OPEN, cells);
+    for (size_t c = 0; c < cells; c++) {
+        f->positions[c] = NOT_ON_FRONTIER;
+    }
+
+    bool empty = true;
+    for (size_t i = 0; i < board->size; i++) {
+        for (size_t j = 0; j < board->size; j++) {
+            if (board->tiles[i][j]) {
+                empty = false;
+            } else {
+                uint8_t key = frontier_constraintAt(board, i, j);
+                if (key != FRONTIER_OPEN) {
+                    f->keys[i * f->size + j] = key;
+                    bucket_push(f, key, i * f->size + j);
+                }
+            }
+        }
+    }
+    if (empty && board->size) {
+        bucket_push(f, FRONTIER_OPEN, (board->size / 2) * f->size + board->size / 2);
+    }
+}
+
+void frontier_free(frontier* f) {
+    for (size_t k = 0; k < FRONTIER_KEYS; k++) {
+        free(f->buckets[k].cells);
+    }
+    free(f->keys);
+    free(f->positions);
+    free(f->log);
+    memset(f, 0, sizeof(*f));
+}
+
+void frontier_place(frontier* f, const sized_board* board, size_t row, size_t column) {
+    size_t cell = row * f->size + column;
+    frontier_set(f, cell, FRONTIER_OPEN, false);
+
+    size_t neighbours[4], count = 0;
+    if (row > 0) neighbours[count++] = cell - f->size;
+    if (column + 1 < f->size) neighbours[count++] = cell + 1;
+    if (row + 1 < f->size) neighbours[count++] = cell + f->size;
+    if (column > 0) neighbours[count++] = cell - 1;
+    for (size_t k = 0; k < count; k++) {
+        size_t n = neighbours[k];
+        if (!board->tiles[n / f->size][n % f->size]) {
+            frontier_set(f, n, frontier_constraintAt(board, n / f->size, n % f->size), true);
+        }
+    }
+}
+
+size_t frontier_mark(const frontier* f) {
+    return f->logSize;
+}
+
+void frontier_undo(frontier* f, size_t mark) {
+    while (f->logSize > mark) {
+        frontier_change* c = &f->log[--f->logSize];
+        // later changes are undone already, so a cell on the frontier is last in its bucket
+        if (f->positions[c->cell] != NOT_ON_FRONTIER) {
+            bucket_remove(f, c->cell);
+        }
+        f->keys[c->cell] = c->key;
+        if (c->position != NOT_ON_FRONTIER) {
+            bucket_insertAt(f, c->key, c->cell, c->position);
+        }
+    }
+}
+
+void frontier_commit(frontier* f) {
+    f->logSize = 0;
+}
+
+void frontier_matchingKeys(uint8_t edges, uint8_t keys[static FRONTIER_MATCHES]) {
+    for (unsigned open = 0; open < FRONTIER_MATCHES; open++) {
+        unsigned key = edges;
+        for (unsigned d = 0; d < 4; d++) {
+            if (open & (1u << d)) {
+                key |= (unsigned)FRONTIER_ANY << (2 * d);
+            }
+        }
+        keys[open] = (uint8_t)key;
+    }
+}
+
+const size_t* frontier_cells(const frontier* f, uint8_t key, size_t* count) {
+    *count = f->buckets[key].count;
+    return f->buckets[key].cells;
+}
+
+void frontier_watch(frontier* f, uint8_t edges) {
+    if (f->watchers[edges]++ > 0) {
+        return;
+    }
+    uint8_t keys[FRONTIER_MATCHES];
+    frontier_matchingKeys(edges, keys);
+    size_t cells = 0;
+    for (size_t m = 0; m < FRONTIER_MATCHES; m++) {
+        cells += f->buckets[keys[m]].count;
+    }
+    f->watched[f->watchedCount++] = edges;
+    f->fits[edges] = cells;
+    if (cells) {
+        f->placeable++;
+    }
+}
+
+void frontier_unwatch(frontier* f, uint8_t edges) {
+    if (--f->watchers[edges] > 0) {
+        return;
+    }
+    for (size_t w = 0; w < f->watchedCount; w++) {
+        if (f->watched[w] == edges) {
+            f->watched[w] = f->watched[--f->watchedCount];
+            break;
+        }
+    }
+    if (f->fits[edges]) {
+        f->placeable--;
+    }
+    f->fits[edges] = 0;
+}
+
+size_t frontier_size(const frontier* f) {
+    size_t count = 0;
+    for (size_t k = 0; k < FRONTIER_KEYS; k++) {
+        count += f->buckets[k].count;
+    }
+    return count;
+}
@@ -0,0 +1,169 @@
+#ifndef FRONTIER_H
+#define FRONTIER_H
+/** @file frontier.h */
+
+#include "board.h"
+
+#include <stdint.h>
+
+/** @addtogroup Frontier
+* index of the empty cells next to placed tiles, grouped by the edges a tile needs to fit there.
+* a constraint key packs 2 bits per edge like tile_info::edges, FRONTIER_ANY marks an edge
+* without a neighbour. changes are logged so a line of placements can be taken back
+* leaving the index exactly as it was, including the order of the cells.
+* edges of the tiles in play can be watched: for every watched edges the cells accepting them
+* are counted along as cells join and leave the frontier, so tiles without any legal placement
+* are known without looking at a single cell
+* @{
+*/
+
+/** edge value of a key accepting every element */
+#define FRONTIER_ANY 3
+/** key of a cell without any neighbour, such cells are not on the frontier */
+#define FRONTIER_OPEN 0xFF
+/** amount of distinct constraint keys */
+#define FRONTIER_KEYS 256
+/** keys a tile with given edges fits, one per subset of edges left open */
+#define FRONTIER_MATCHES 16
+
+typedef struct {
+    size_t* cells;
+    size_t count;
+    size_t capacity;
+} frontier_bucket;
+
+typedef struct {
+    size_t cell;
+    size_t position;    // position in the bucket before the change, SIZE_MAX if not on the frontier
+    uint8_t key;        // key before the change
+} frontier_change;
+
+typedef struct {
+    size_t size;        // side of the indexed board, cells are row * size + column
+    uint8_t* keys;
+    size_t* positions;  // position of every cell in its bucket, SIZE_MAX if not on the frontier
+    frontier_bucket buckets[FRONTIER_KEYS];
+    frontier_change* log;
+    size_t logSize;
+    size_t logCapacity;
+    size_t watchers[FRONTIER_KEYS];     // watches of every edges, see frontier_watch
+    uint8_t watched[FRONTIER_KEYS];     // edges with watchers, in the order they were first watched
+    size_t watchedCount;
+    size_t fits[FRONTIER_KEYS];         // cells accepting the edges, kept for watched edges
+    size_t placeable;                   // watched edges with at least one cell
+} frontier;
+/** @} */
+
+/**
+* build the index of a board with one scan.
+* on an empty board the centre is the only cell and accepts every tile
+* @param [out] f frontier to initialize
+* @param [in] board board to index
+*/
+void frontier_init(frontier* f, const sized_board* board);
+
+/**
+* free the memory of the index.
+* @param [in,out] f frontier to free
+*/
+void frontier_free(frontier* f);
+
+/**
+* update the index after a tile was put on the board.
+* only the cell and its four neighbours are looked at
+* @param [in,out] f frontier of the board
+* @param [in] board board with the tile already placed
+* @param [in] row row of the placed tile
+* @param [in] column column of the placed tile
+*/
+void frontier_place(frontier* f, const sized_board* board, size_t row, size_t column);
+
+/**
+* current position in the change log, to return to with frontier_undo.
+* @param [in] f frontier
+* @return mark
+*/
+size_t frontier_mark(const frontier* f);
+
+/**
+* take back every change made since the mark.
+* @param [in,out] f frontier
+* @param [in] mark value of frontier_mark before the changes
+*/
+void frontier_undo(frontier* f, size_t mark);
+
+/**
+* forget the change log, the placements made so far stay for good.
+* @param [in,out] f frontier
+*/
+void frontier_commit(frontier* f);
+
+/**
+* constraint key of an empty cell: the facing edges of its neighbours, FRONTIER_ANY where there is none.
+* tile_fitting of the key holds the tiles that fit the cell
+* @param [in] board board
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @return key, FRONTIER_OPEN for a cell without neighbours
+*/
+uint8_t frontier_constraintAt(const sized_board* board, size_t row, size_t column);
+
+/**
+* list the constraint keys of cells a tile fits in.
+* @param [in] edges packed edges of the tile, see tile_info::edges
+* @param [out] keys FRONTIER_MATCHES keys
+*/
+void frontier_matchingKeys(uint8_t edges, uint8_t keys[static FRONTIER_MATCHES]);
+
+/**
+* cells with a constraint key.
+* the order of the cells depends on the history of the index
+* @param [in] f frontier
+* @param [in] key constraint key
+* @param [out] count amount of cells
+* @return cells, valid until the next change of the index
+*/
+const size_t* frontier_cells(const frontier* f, uint8_t key, size_t* count);
+
+/**
+* count the cells accepting the edges from now on, for every further change of the index too.
+* edges can be watched several times, once per tile having them, the watches are not part of the change log.
+* @param [in,out] f frontier
+* @param [in] edges packed edges of a tile as placed, see tile_info::edges
+*/
+void frontier_watch(frontier* f, uint8_t edges);
+
+/**
+* take back one watch of the edges, they stop being counted after their last one.
+* @param [in,out] f frontier
+* @param [in] edges packed edges watched before
+*/
+void frontier_unwatch(frontier* f, uint8_t edges);
+
+/**
+* amount of cells a tile fits in.
+* @param [in] f frontier
+* @param [in] edges packed edges of the tile as placed, they have to be watched
+* @return amount of cells
+*/
+static inline size_t frontier_fits(const frontier* f, uint8_t edges) {
+    return f->fits[edges];
+}
+
+/**
+* amount of watched edges that fit at least one cell, 0 when none of the watched tiles can be placed.
+* @param [in] f frontier
+* @return amount of placeable edges
+*/
+static inline size_t frontier_placeable(const frontier* f) {
+    return f->placeable;
+}
+
+/**
+* amount of cells on the frontier.
+* @param [in] f frontier
+* @return amount of cells
+*/
+size_t frontier_size(const frontier* f);
+
+#endif
@@ -5,28 +5,29 @@
 #include <time.h>
 #include <string.h>
 
-void tileGenerator(const char* default_tiles,const char* new_tiles, int num);
+void tileGenerator(const char* default_tiles,const char* new_tiles, size_t num);
 
 int main(int argc, char* argv[]) {
-    if(argc != 4) {
+    if(argc != 4 || atoi(argv[3]) < 0) {
         puts("Wrong input!\n"
              "Format: [DEFAULT_TILES_FILE] [NEW_TILES_FILE] [NUM_OF_NEW_TILES]");
         return EXIT_FAILURE;
     }
 
-    tileGenerator(argv[1], argv[2], atoi(argv[3]));
+    tileGenerator(argv[1], argv[2], (size_t)atoi(argv[3]));
     return EXIT_SUCCESS;
 }
 
-void tileGenerator(const char* default_tiles,const char* new_tiles, int num) {
+void tileGenerator(const char* default_tiles,const char* new_tiles, size_t num) {
     sized_tlist default_list = tlist_init_exit_on_err(default_tiles);
     
-    sized_tlist new_list;
+    sized_tlist new_list = { 0 };
     new_list.size = num;
+    new_list.capacity = num;
     new_list.tiles = malloc(num * sizeof(tile*));
 
     srand(time(NULL));
-    for(int i = 0; i < num; i++) {
+    for(size_t i = 0; i < num; i++) {
         new_list.tiles[i] = default_list.tiles[rand() % default_list.size];
     }
 
@@ -22,12 +22,47 @@ void usage() {
          "tiles-list-file and board-file should be flies in current directory\n"
          "if both tiles-list-file and board-file specified run in auto mode\n"
          "if only tiles-list given use list specified in interactive mode\n"
-         "if none file specified use default tile list for interactive mode\n");
+         "if none file specified use default tile list for interactive mode\n"
+         "\n"
+         "subcommands:\n"
+         "  carcassonne ab tiles-list-file board-file\n"
+         "      play the pile out exhaustively and with --top-k or --strategy,\n"
+         "      compare score and time\n"
+         "  carcassonne replay move-log-file [start-board-file]\n"
+         "      print the score after every move of a log written with --log\n"
+         "  carcassonne plan tiles-list-file board-file\n"
+         "      place the tiles in list order as they are dealt, planning --window\n"
+         "      tiles ahead, print every step and write the final board\n"
+         "  carcassonne score-batch board-file|directory|@list-file...\n"
+         "      score saved boards on --threads workers, one line per board\n"
+         "      with castle, road and temple points, in input order\n"
+         "\n"
+         "options:\n"
+         "  --strategy s    exhaustive (default), ordered or mcts\n"
+         "  --top-k n       rank moves with a static estimate, score only the best n\n"
+         "  --deadline-ms n answer within n ms with the best move found so far,\n"
+         "                  prints whether the search was exhaustive,\n"
+         "                  selects the ordered search, not with --strategy exhaustive\n"
+         "  --endgame n     solve the rest of the game exactly from n tiles left on,\n"
+         "                  as deep as the time of the move allows\n"
+         "  --threads n     worker threads, 0 uses every cpu\n"
+         "  --nodes n       mcts: tree nodes added per move (default 20000), 0 for only --time-ms\n"
+         "  --time-ms n     mcts: time limit per move\n"
+         "  --horizon n     mcts: tiles placed by a rollout (default 8), 0 for all\n"
+         "  --window n      plan: tiles looked ahead before placing one (default 3)\n"
+         "  --beam n        plan: positions kept at every depth (default 16)\n"
+         "  --log file      auto mode and plan: append the moves to a binary move log\n"
+         "  --rank n        auto mode: list the n best moves of the exhaustive search first\n"
+         "  --stable-list   keep the order of the tile list when a tile is taken,\n"
+         "                  by default the last tile fills the gap\n"
+         "  --board-header  auto mode: write the board with a #board width height row column\n"
+         "                  header line, a board read with one always keeps it\n"
+         "  --format f      score-batch: csv (default) or json\n"
+         "  --stats         print search counters\n");
 }
 
 void init_tlist_interactive(sized_tlist* list) {
-    free(list->tiles);
-    list->tiles = 0;
+    tlist_free(list);
     char name[64] = { 0 };
     while (true) {
         fputs("enter name of a file containing tile list: ", stdout);
@@ -85,23 +120,15 @@ tile* choose_tile_interactive(sized_tlist* list, tile** t) {
         }
         puts("choice out of bounds");
     }
-    // choose right tile based on user input (numbering from 1 and ignore null pointers)
-    for (size_t i = 0, count = 0; i < list->size; ++i) {
-        if (list->tiles[i] && ++count == choice) {
-            *t = list->tiles[i];
-            list->tiles[i] = 0;
-        }
+    // numbering from 1, 0 keeps the current tile
+    if (choice == 0) {
+        return temp;
     }
-    // if current tile is not null put it back on the list
+    // the tile in hand is freed on its own, it must not stay in the pool of the list
+    *t = tlist_detach(list, tlist_eraseAt(list, (int)(choice - 1)));
+    // if current tile is not null put it back on the list, into the slot just freed
     if (temp) {
-        // find empty space
-        for (size_t i = 0; i < list->size; ++i) {
-            // TODO: if it wont find empty space it will leak memory
-            if (list->tiles[i] == 0) {
-                list->tiles[i] = temp;
-                break;
-            }
-        }
+        tlist_append(list, temp);
     }
     return temp;
 }
@@ -223,7 +250,20 @@ state_cmd rotate_tile_interactive_state(state* s) {
 
 state_cmd board_print_legal_moves_state(state* s) {
     assert(s);
-    board_print_legal_moves(s->board, s->c_tile);
+    move_buffer moves;
+    move_buffer_init(&moves);
+    if (s->c_tile && board_is_empty(s->board)) {
+        // the first tile can go anywhere
+        for (size_t i = 0; i < s->board->size; ++i) {
+            for (size_t j = 0; j < s->board->size; ++j) {
+                move_buffer_push(&moves, (int)i, (int)j, -1, -1);
+            }
+        }
+    } else if (s->c_tile) {
+        getMovesForTile(s->board, s->c_tile, &moves);
+    }
+    board_print_legal_moves(s->board, &moves);
+    move_buffer_free(&moves);
     return CMD_KNOWN;
 }
 
@@ -235,7 +275,20 @@ state_cmd place_tile_interactive_state(state* s) {
 
 state_cmd score_interactive_state(state* s) {
     assert(s);
-    printf("current score is: %d\n", score(s->board));
+    static const char* names[] = { "castle", "road", "temple" };
+    scorer sc;
+    score_detailed d;
+    scorer_init(&sc);
+    score_detailed_init(&d, true);
+    scorer_scoreDetailed(&sc, s->board, &d);
+    printf("current score is: %d (castles %d, roads %d, temples %d)\n", d.total, d.castle, d.road, d.temple);
+    for (size_t i = 0; i < d.regionCount; i++) {
+        const score_region* r = &d.regions[i];
+        printf("  %-6s at [%d, %d]: %zu tiles, %s, %d shields, %d points\n", names[r->type], r->row, r->column,
+               r->tiles, r->completed ? "completed" : "open", r->shields, r->points);
+    }
+    score_detailed_free(&d);
+    scorer_free(&sc);
     return CMD_KNOWN;
 }
 
@@ -356,6 +409,7 @@ void run_interactive(gamemode mode, const char* list_filename) {
 
     tlist_free(&list);
     board_free(&board);
-    tile_free(c_tile);
-    free(c_tile);
+    // the tile in hand is owned by the state, not by the list
+    tile_free(s.c_tile);
+    free(s.c_tile);
 }
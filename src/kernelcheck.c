@@ -0,0 +1,220 @@
+#include "occupancy.h"
+#include "pile.h"
+#include "tile_tables.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the kernels this build uses, the same conditions as in occupancy.c
+#if defined(__AVX2__) && !defined(OCCUPANCY_SCALAR)
+#define OCCUPANCY_VARIANT "avx2"
+#elif defined(__SSE2__) && !defined(OCCUPANCY_SCALAR)
+#define OCCUPANCY_VARIANT "sse2"
+#else
+#define OCCUPANCY_VARIANT "scalar"
+#endif
+#if defined(__AVX2__) && !defined(PILE_SCALAR)
+#define PILE_VARIANT "avx2"
+#elif defined(__SSE2__) && !defined(PILE_SCALAR)
+#define PILE_VARIANT "sse2"
+#else
+#define PILE_VARIANT "scalar"
+#endif
+
+// random bitmaps per check, sizes around the word and lane borders come first
+#define BOARDS 2000
+#define MAX_SIZE 300
+static const size_t EDGE_SIZES[] = { 1, 2, 3, 63, 64, 65, 127, 128, 129, 255, 256, 257 };
+// random piles per check, every one is scanned with each constraint and rotation
+#define PILES 200
+#define MAX_PILE 1000
+static const size_t PILE_SIZES[] = { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 95, 96, 97 };
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// marks about one cell in every `oneIn`
+static void random_bitmap(occupancy* o, size_t size, uint64_t oneIn, uint64_t* state) {
+    occupancy_reset(o, size);
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < size; j++) {
+            if (next_random(state) % oneIn == 0) {
+                occupancy_set(o, i, j);
+            }
+        }
+    }
+}
+
+// neighbours of a cell read one by one, the reference of every kernel
+static int reference_count(const occupancy* o, size_t row, size_t column) {
+    int count = 0;
+    for (size_t r = row ? row - 1 : 0; r <= row + 1 && r < o->size; r++) {
+        for (size_t c = column ? column - 1 : 0; c <= column + 1 && c < o->size; c++) {
+            if ((r != row || c != column) && occupancy_get(o, r, c)) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// every word of the planes, the padding included, has to be what the reference counts give
+static bool check_occupancy(const occupancy* occupied, const occupancy* temples,
+                            occupancy planes[static OCCUPANCY_PLANES], occupancy expected[static OCCUPANCY_PLANES]) {
+    size_t size = occupied->size;
+    int score = 0;
+    for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+        occupancy_reset(&expected[k], size);
+    }
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < size; j++) {
+            int count = reference_count(occupied, i, j);
+            if (occupancy_neighbours(occupied, i, j) != count) {
+                fprintf(stderr, "occupancy_neighbours: size %zu cell %zu %zu\n", size, i, j);
+                return false;
+            }
+            for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+                if (count & (1 << k)) {
+                    occupancy_set(&expected[k], i, j);
+                }
+            }
+            if (occupancy_get(temples, i, j)) {
+                score += 1 + count;
+            }
+        }
+    }
+
+    occupancy_countNeighbours(occupied, planes);
+    for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+        if (planes[k].stride != expected[k].stride
+            || memcmp(planes[k].bits, expected[k].bits, (size + 2) * planes[k].stride * sizeof(uint64_t)) != 0) {
+            fprintf(stderr, "occupancy_countNeighbours: size %zu plane %zu\n", size, k);
+            return false;
+        }
+    }
+    if (occupancy_templeScore(occupied, temples) != score) {
+        fprintf(stderr, "occupancy_templeScore: size %zu\n", size);
+        return false;
+    }
+    return true;
+}
+
+static bool run_occupancy(uint64_t* state) {
+    occupancy occupied, temples, planes[OCCUPANCY_PLANES], expected[OCCUPANCY_PLANES];
+    occupancy_init(&occupied);
+    occupancy_init(&temples);
+    for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+        occupancy_init(&planes[k]);
+        occupancy_init(&expected[k]);
+    }
+    bool ok = true;
+    size_t edges = sizeof(EDGE_SIZES) / sizeof(EDGE_SIZES[0]);
+    for (size_t b = 0; b < BOARDS && ok; b++) {
+        size_t size = b < edges ? EDGE_SIZES[b] : 1 + (size_t)(next_random(state) % MAX_SIZE);
+        // from nearly empty to full, temples among the marked cells and elsewhere
+        random_bitmap(&occupied, size, 1 + next_random(state) % 8, state);
+        random_bitmap(&temples, size, 1 + next_random(state) % 16, state);
+        ok = check_occupancy(&occupied, &temples, planes, expected);
+    }
+    occupancy_free(&occupied);
+    occupancy_free(&temples);
+    for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+        occupancy_free(&planes[k]);
+        occupancy_free(&expected[k]);
+    }
+    printf("occupancy %-6s %s\n", OCCUPANCY_VARIANT, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// random tile codes, the edges of every one as pile_fromList packs them
+static void random_pile(tile_pile* p, uint16_t* codes, size_t size, uint64_t* state) {
+    if (size > p->capacity) {
+        free(p->edges);
+        free(p->mods);
+        p->capacity = size;
+        p->edges = malloc(p->capacity);
+        p->mods = malloc(p->capacity);
+    }
+    p->size = size;
+    for (size_t j = 0; j < size; j++) {
+        codes[j] = (uint16_t)(next_random(state) % TILE_CODES);
+        p->edges[j] = tile_infos[codes[j]].edges;
+        p->mods[j] = 0;
+    }
+}
+
+// the bits of every constraint and rotation against the tiles turned one by one and looked up in tile_fitting
+static bool check_pile(const tile_pile* p, const uint16_t* codes, uint64_t* bits, uint64_t* expected) {
+    size_t words = (p->size + 63) / 64;
+    for (unsigned constraint = 0; constraint < TILE_CONSTRAINTS; constraint++) {
+        for (unsigned rotation = 0; rotation < 4; rotation++) {
+            size_t count = 0;
+            memset(expected, 0, words * sizeof(uint64_t));
+            for (size_t j = 0; j < p->size; j++) {
+                uint16_t code = codes[j];
+                for (unsigned k = 0; k < rotation; k++) {
+                    code = tile_infos[code].rotated;
+                }
+                if (edge_set_has(&tile_fitting[constraint], tile_infos[code].edges)) {
+                    expected[j / 64] |= (uint64_t)1 << (j % 64);
+                    count++;
+                }
+            }
+            // a word past the result has to stay untouched
+            bits[words] = 0x5A5A5A5A5A5A5A5AULL;
+            if (pile_fitting(p, (uint8_t)constraint, rotation, bits) != count
+                || memcmp(bits, expected, words * sizeof(uint64_t)) != 0 || bits[words] != 0x5A5A5A5A5A5A5A5AULL) {
+                fprintf(stderr, "pile_fitting: size %zu constraint %u rotation %u\n", p->size, constraint, rotation);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool run_pile(uint64_t* state) {
+    tile_pile p;
+    pile_init(&p);
+    uint16_t* codes = malloc(MAX_PILE * sizeof(uint16_t));
+    uint64_t* bits = malloc(((MAX_PILE + 63) / 64 + 1) * sizeof(uint64_t));
+    uint64_t* expected = malloc((MAX_PILE + 63) / 64 * sizeof(uint64_t));
+    bool ok = true;
+    size_t edges = sizeof(PILE_SIZES) / sizeof(PILE_SIZES[0]);
+    for (size_t n = 0; n < PILES && ok; n++) {
+        size_t size = n < edges ? PILE_SIZES[n] : (size_t)(next_random(state) % (MAX_PILE + 1));
+        random_pile(&p, codes, size, state);
+        ok = check_pile(&p, codes, bits, expected);
+    }
+    pile_free(&p);
+    free(codes);
+    free(bits);
+    free(expected);
+    printf("pile      %-6s %s\n", PILE_VARIANT, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t state = argc > 1 ? strtoull(argv[1], NULL, 10) : 0x9E3779B97F4A7C15ULL;
+    if (state == 0) {
+        fputs("usage: kernelcheck [seed]\n", stderr);
+        return 1;
+    }
+#if defined(__AVX2__) && defined(__GNUC__)
+    // the build targets AVX2, a cpu without it cannot run the kernels at all
+    if (!__builtin_cpu_supports("avx2")) {
+        puts("avx2 is not supported by this cpu, skipped");
+        return 0;
+    }
+#endif
+    bool ok = run_occupancy(&state);
+    ok = run_pile(&state) && ok;
+    return ok ? 0 : 1;
+}
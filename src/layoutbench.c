@@ -0,0 +1,124 @@
+#include "board.h"
+#include "calculator.h"
+#include "morton.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// tiles of default_tiles.txt, the boards are built from them
+static const char* const TILES[] = {
+    "ffrft", "fffft", "cccc*", "rcrf_", "cfff_", "fcfc_", "fccf_",
+    "crrf_", "rcfr_", "rcrr_", "rfrf_", "ffrr_", "frrr_", "rrrr_"
+};
+#define TILE_KINDS (sizeof(TILES) / sizeof(TILES[0]))
+// tries of a random tile and rotation before a cell is left empty
+#define CELL_TRIES 32
+// one cell in HOLE_ONE_IN is left empty on purpose, so not every castle and road gets closed
+#define HOLE_ONE_IN 16
+// cells scored per measurement, smaller boards are scored more often
+#define CELLS_PER_RUN (1u << 23)
+
+static const size_t DEFAULT_SIZES[] = { 64, 256, 1000, 1024, 2048 };
+
+static double now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e3 + (double)now.tv_nsec / 1e6;
+}
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// fills the board in row-major order with random tiles that match the tiles above and left of them,
+// a cell without neighbours takes any tile
+static size_t board_build(sized_board* board, uint64_t seed) {
+    uint64_t state = seed;
+    size_t placed = 0;
+    tile* t = NULL;
+    for (size_t i = 0; i < board->size; i++) {
+        for (size_t j = 0; j < board->size; j++) {
+            if (next_random(&state) % HOLE_ONE_IN == 0) {
+                continue;
+            }
+            for (unsigned k = 0; k < CELL_TRIES; k++) {
+                if (!t) {
+                    tile_alloc_from_str(TILES[next_random(&state) % TILE_KINDS], &t);
+                }
+                tile_rotate_amount((rotation_t)(next_random(&state) % 4), t);
+                if (!board_tileHasNeighbour(board, i, j) || tile_fits(board, t, i, j)) {
+                    tile_place(&board->tiles[i][j], t);
+                    t = NULL;
+                    placed++;
+                    break;
+                }
+            }
+        }
+    }
+    tile_free(t);
+    free(t);
+    return placed;
+}
+
+// milliseconds per pass, scores with regions so the union-find is part of the measurement
+static double measure(scorer* s, sized_board* board, size_t runs, score_detailed* out) {
+    double start = now_ms();
+    for (size_t r = 0; r < runs; r++) {
+        scorer_scoreDetailed(s, board, out);
+    }
+    return (now_ms() - start) / (double)runs;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? (size_t)(argc - 1) : sizeof(DEFAULT_SIZES) / sizeof(DEFAULT_SIZES[0]);
+    bool ok = true;
+    printf("   size     tiles  row-major ms  z-order ms  speedup\n");
+    for (size_t n = 0; n < count; n++) {
+        size_t size = argc > 1 ? strtoul(argv[n + 1], NULL, 10) : DEFAULT_SIZES[n];
+        if (size == 0) {
+            fputs("usage: layoutbench [board-size ...]\n", stderr);
+            return 1;
+        }
+        sized_board board = { board_alloc(size), size };
+        size_t tiles = board_build(&board, 0x9E3779B97F4A7C15ULL + size);
+        size_t runs = CELLS_PER_RUN / (size * size) + 1;
+
+        morton_board cells;
+        morton_init(&cells);
+        morton_fromBoard(&cells, &board);
+
+        scorer s;
+        scorer_init(&s);
+        score_detailed rows, zorder;
+        score_detailed_init(&rows, true);
+        score_detailed_init(&zorder, true);
+
+        // the first pass of each grows the scorer, it is not timed
+        scorer_scoreDetailed(&s, &board, &rows);
+        double rowMs = measure(&s, &board, runs, &rows);
+        scorer_setCells(&s, &cells);
+        scorer_scoreDetailed(&s, &board, &zorder);
+        double zMs = measure(&s, &board, runs, &zorder);
+
+        printf("%7zu %9zu %13.3f %11.3f %8.2f\n", size, tiles, rowMs, zMs, rowMs / zMs);
+        if (rows.total != zorder.total || rows.castle != zorder.castle || rows.road != zorder.road
+            || rows.regionCount != zorder.regionCount) {
+            fprintf(stderr, "layouts disagree on the board of size %zu: %d and %d\n", size, rows.total, zorder.total);
+            ok = false;
+        }
+
+        score_detailed_free(&rows);
+        score_detailed_free(&zorder);
+        scorer_free(&s);
+        morton_free(&cells);
+        board_free(&board);
+    }
+    return ok ? 0 : 1;
+}
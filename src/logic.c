@@ -5,11 +5,63 @@
 #include "tile.h"
 #include "tlist.h"
 #include "ai.h"
+#include "batch.h"
+#include "mcts.h"
+#include "movelog.h"
+#include "plan.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// top-k used by the a/b harness when none is given
+#define AB_DEFAULT_TOP_K 8
+
+typedef struct {
+    ai_config ai;
+    bool stats;
+    bool stableList;
+    bool boardHeader;
+    size_t rank;
+    const char* strategy;
+    const char* log;
+    const char* format;
+} options;
+
+static options opts = { AI_CONFIG_DEFAULT, false, false, false, 0, 0, 0, 0 };
+
+static const struct { const char* arg; size_t* value; } value_opt_list[] = {
+    { "--top-k",    &opts.ai.topK },
+    { "--threads",  &opts.ai.threads },
+    { "--nodes",    &opts.ai.nodes },
+    { "--time-ms",  &opts.ai.timeMs },
+    { "--horizon",  &opts.ai.horizon },
+    { "--deadline-ms", &opts.ai.deadlineMs },
+    { "--rank",     &opts.rank },
+    { "--endgame",  &opts.ai.endgameTiles },
+    { "--window",   &opts.ai.planWindow },
+    { "--beam",     &opts.ai.planBeam },
+};
+
+static const struct { const char* arg; const char** value; } string_opt_list[] = {
+    { "--strategy", &opts.strategy },
+    { "--log",      &opts.log },
+    { "--format",   &opts.format },
+};
+
+static const struct { const char* name; ai_strategy func; } strategy_list[] = {
+    { "exhaustive", ai_exhaustiveSearch },
+    { "ordered",    ai_orderedSearch },
+    { "mcts",       mcts_search },
+};
+
+static const struct { const char* arg; bool* flag; } flag_opt_list[] = {
+    { "--stats",    &opts.stats },
+    { "--stable-list", &opts.stableList },
+    { "--board-header", &opts.boardHeader },
+};
+
 void handle_args(int argc, char* argv[]) {
     if (argc < 1) {
         return;
@@ -33,6 +85,74 @@ void handle_args(int argc, char* argv[]) {
     }
 }
 
+static bool parse_size(const char* str, size_t* value) {
+    char* end;
+    unsigned long long temp = strtoull(str, &end, 10);
+    if (*str == '\0' || *str == '-' || *end != '\0') {
+        return false;
+    }
+    *value = (size_t)temp;
+    return true;
+}
+
+void parse_options(int* argc, char* argv[]) {
+    int kept = 1;
+    for (int i = 1; i < *argc; ++i) {
+        bool matched = false;
+        for (size_t j = 0; j < ARR_LEN(flag_opt_list) && !matched; ++j) {
+            if (STR_EQ(argv[i], flag_opt_list[j].arg)) {
+                *flag_opt_list[j].flag = true;
+                matched = true;
+            }
+        }
+        for (size_t j = 0; j < ARR_LEN(value_opt_list) && !matched; ++j) {
+            if (STR_EQ(argv[i], value_opt_list[j].arg)) {
+                if (i + 1 >= *argc || !parse_size(argv[i + 1], value_opt_list[j].value)) {
+                    fprintf(stderr, "option %s expects a number\n", argv[i]);
+                    exit(EXIT_FAILURE);
+                }
+                ++i;
+                matched = true;
+            }
+        }
+        for (size_t j = 0; j < ARR_LEN(string_opt_list) && !matched; ++j) {
+            if (STR_EQ(argv[i], string_opt_list[j].arg)) {
+                if (i + 1 >= *argc) {
+                    fprintf(stderr, "option %s expects a value\n", argv[i]);
+                    exit(EXIT_FAILURE);
+                }
+                *string_opt_list[j].value = argv[++i];
+                matched = true;
+            }
+        }
+        // keep positional arguments in their order
+        if (!matched) {
+            argv[kept++] = argv[i];
+        }
+    }
+    argv[kept] = NULL;
+    *argc = kept;
+}
+
+// strategy named by --strategy, without it --top-k or --deadline-ms select the ordered search
+static ai_strategy chosen_strategy(void) {
+    if (!opts.strategy) {
+        return opts.ai.topK || opts.ai.deadlineMs ? ai_orderedSearch : ai_exhaustiveSearch;
+    }
+    for (size_t i = 0; i < ARR_LEN(strategy_list); ++i) {
+        if (STR_EQ(opts.strategy, strategy_list[i].name)) {
+            // the exhaustive search looks at every move, it has no point to stop at
+            if (strategy_list[i].func == ai_exhaustiveSearch && opts.ai.deadlineMs) {
+                fputs("--deadline-ms needs the ordered or mcts strategy\n", stderr);
+                exit(EXIT_FAILURE);
+            }
+            return strategy_list[i].func;
+        }
+    }
+    fprintf(stderr, "unknown strategy: %s\n", opts.strategy);
+    exit(EXIT_FAILURE);
+}
+
 FILE* exit_on_bad_file_open(const char* filename, const char* mode, const char* name) {
     FILE* file;
     if ((file = fopen(filename, mode)) == 0) {
@@ -47,24 +167,291 @@ void check_valid_file(const char* filename, const char* mode, const char* name)
     fclose(temp);
 }
 
+// the best moves of the exhaustive search, in board file coordinates like the move log
+static void print_ranked(sized_board* board, sized_tlist* list, size_t count) {
+    move* ranked = malloc(count * sizeof(move));
+    size_t found = ai_rankMoves(board, list, ranked, count, NULL);
+    for (size_t i = 0; i < found; ++i) {
+        char str[5];
+        printf("%zu: tile %d %.5s rotation %d at %d %d score %d\n", i + 1, ranked[i].tileIndex,
+               tile_to_str(list->tiles[ranked[i].tileIndex], str), ranked[i].rotation, ranked[i].row - 1,
+               ranked[i].column - 1, ranked[i].score);
+    }
+    free(ranked);
+}
+
 void run_auto(const char* list_filename, const char* board_filename) {
     sized_tlist list = tlist_init_exit_on_err(list_filename);
+    list.order = opts.stableList ? TLIST_STABLE : TLIST_SWAP;
+    // a board written with a header keeps it, the origin follows the tiles across moves
+    board_header header = { 0, 0, 0, 0 };
+    bool withHeader = board_read_header(board_filename, &header) || opts.boardHeader;
     sized_board board = board_init_exit_on_err(AUTO, board_filename);
     
+    if (opts.rank) {
+        print_ranked(&board, &list, opts.rank);
+    }
+
     // make a move found by an algorithm
-    ai_makeMove(&board,&list,ai_bruteForce(&board,&list));
+    ai_stats stats = { 0 };
+    ai_strategy strategy = chosen_strategy();
+    move* m = ai_search(strategy,&board,&list,&opts.ai,&stats);
+    // log the tile as it is in the list, the board file has a margin of 1 around the loaded one
+    if (m && opts.log && !movelog_append(opts.log, list.tiles[move_getTileIndex(m)], (rotation_t)move_getRotation(m),
+                                         move_getRow(m) - 1, move_getColumn(m) - 1)) {
+        fprintf(stderr, "error writing move log %s\n", opts.log);
+    }
+    ai_makeMove(&board,&list,m);
     printf("\nScore: %i\n",score(&board));
+    if (opts.ai.deadlineMs) {
+        printf("exhaustive: %s\n", stats.cutoffs ? "no" : "yes");
+    }
+    if (opts.stats) {
+        ai_printStats(&stats);
+    }
     
     // write updated objects to files
     tlist_write(&list,list_filename);
+    // the loaded board got a margin of 1, trimming drops the empty rows and columns in front
+    size_t dh, dw;
+    board_leading_empty(&board, &dh, &dw);
     board_trim(&board);
-    board_write(&board,board_filename);
+    if (withHeader) {
+        board_write_header(&board, board_filename, header.row - 1 + (long)dh, header.column - 1 + (long)dw);
+    } else {
+        board_write(&board,board_filename);
+    }
+
+    tlist_free(&list);
+    board_free(&board);
+}
+
+// play the whole pile with the strategy on copies of board and list, print the result
+static void ab_play(const char* name, const sized_board* board, const sized_tlist* list,
+                    ai_strategy strategy, const ai_config* config) {
+    sized_board b = { board_alloc(board->size), board->size };
+    board_copy(board, &b);
+    sized_tlist l;
+    tlist_copy(list, &l);
+
+    ai_stats stats = { 0 };
+    double start = ai_clockMs();
+    size_t moves = ai_playGame(&b, &l, strategy, config, &stats);
+    double ms = ai_clockMs() - start;
+
+    printf("%-12s score: %-6d moves: %-5zu time: %.1f ms\n", name, score(&b), moves, ms);
+    if (opts.stats) {
+        ai_printStats(&stats);
+    }
+    tlist_free(&l);
+    board_free(&b);
+}
+
+void run_ab(int argc, char* argv[]) {
+    if (argc != 2) {
+        fputs("usage: carcassonne ab tiles-list-file board-file [options]\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    sized_tlist list = tlist_init_exit_on_err(argv[0]);
+    list.order = opts.stableList ? TLIST_STABLE : TLIST_SWAP;
+    sized_board board = board_init_exit_on_err(AUTO, argv[1]);
+
+    ai_config config = opts.ai;
+    char name[32];
+    ai_strategy strategy = ai_orderedSearch;
+    if (opts.strategy) {
+        strategy = chosen_strategy();
+        snprintf(name, sizeof(name), "%s", opts.strategy);
+    } else {
+        if (config.topK == 0) {
+            config.topK = AB_DEFAULT_TOP_K;
+        }
+        snprintf(name, sizeof(name), "top-%zu", config.topK);
+    }
 
+    // the baseline plays greedy to the end, so the gain of the endgame solver shows too
+    ai_config baseline = opts.ai;
+    baseline.endgameTiles = 0;
+    ab_play("exhaustive", &board, &list, ai_exhaustiveSearch, &baseline);
+    ab_play(name, &board, &list, strategy, &config);
+
+    tlist_free(&list);
+    board_free(&board);
+}
+
+void run_plan(int argc, char* argv[]) {
+    if (argc != 2) {
+        fputs("usage: carcassonne plan tiles-list-file board-file [options]\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    sized_tlist list = tlist_init_exit_on_err(argv[0]);
+    // passed over tiles stay in the order they were dealt
+    list.order = TLIST_STABLE;
+    // the board is used as it is in the file, plan coordinates are relative to it
+    board_header header = { 0, 0, 0, 0 };
+    bool withHeader = board_read_header(argv[1], &header) || opts.boardHeader;
+    sized_board board = { 0, 0 };
+    board.size = board_get_size(argv[1]);
+    board.tiles = board_alloc(board.size);
+    if (board.size && !board_parse(argv[1], &board)) {
+        fprintf(stderr, "error parsing board file: %s\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    plan_step* steps = malloc(list.size * sizeof(plan_step));
+    ai_stats stats = { 0 };
+    double start = ai_clockMs();
+    plan_deal(&board, &list, &opts.ai, steps, &stats);
+    double ms = ai_clockMs() - start;
+
+    // extent of the tiles, the log frame of a move starts at the top left of the tiles before it
+    long minRow = LONG_MAX, minColumn = LONG_MAX, maxRow = LONG_MIN, maxColumn = LONG_MIN;
+    for (size_t i = 0; i < board.size; ++i) {
+        for (size_t j = 0; j < board.size; ++j) {
+            if (board.tiles[i][j]) {
+                minRow = MIN(minRow, (long)i);
+                minColumn = MIN(minColumn, (long)j);
+                maxRow = MAX(maxRow, (long)i);
+                maxColumn = MAX(maxColumn, (long)j);
+            }
+        }
+    }
+    size_t placed = 0;
+    for (size_t i = 0; i < list.size; ++i) {
+        char str[5];
+        if (!steps[i].placed) {
+            printf("%zu: tile %.5s passed\n", i + 1, tile_to_str(list.tiles[i], str));
+            continue;
+        }
+        printf("%zu: tile %.5s rotation %d at %ld %ld score %d\n", i + 1, tile_to_str(list.tiles[i], str),
+               steps[i].rotation, steps[i].row, steps[i].column, steps[i].score);
+        if (opts.log && !movelog_append(opts.log, list.tiles[i], steps[i].rotation,
+                                        (int)(steps[i].row - (placed > 0 ? minRow : 0)),
+                                        (int)(steps[i].column - (placed > 0 ? minColumn : 0)))) {
+            fprintf(stderr, "error writing move log %s\n", opts.log);
+        }
+        minRow = MIN(minRow, steps[i].row);
+        minColumn = MIN(minColumn, steps[i].column);
+        maxRow = MAX(maxRow, steps[i].row);
+        maxColumn = MAX(maxColumn, steps[i].column);
+        ++placed;
+    }
+
+    if (minRow != LONG_MAX) {
+        // the final board spans the tiles with a margin like in auto mode, so no road is cut short by
+        // the border when scored, the placed ones are taken from the list back to front
+        size_t size = (size_t)MAX(maxRow - minRow, maxColumn - minColumn) + 3;
+        sized_board final = { board_alloc(size), size };
+        board_copy_offsetted(&board, 1 - minRow, 1 - minColumn, &final);
+        for (size_t i = list.size; i > 0; --i) {
+            const plan_step* step = &steps[i - 1];
+            if (step->placed) {
+                tile* t = tlist_detach(&list, tlist_eraseAt(&list, (int)(i - 1)));
+                final.tiles[step->row - minRow + 1][step->column - minColumn + 1] = tile_rotate_amount(step->rotation, t);
+            }
+        }
+        printf("\nScore: %i\n", score(&final));
+        board_trim(&final);
+        if (withHeader) {
+            board_write_header(&final, argv[1], header.row + minRow, header.column + minColumn);
+        } else {
+            board_write(&final, argv[1]);
+        }
+        board_free(&final);
+        tlist_write(&list, argv[0]);
+    }
+    if (opts.stats) {
+        ai_printStats(&stats);
+        printf("plan: %zu tiles placed, %zu passed in %.3f s\n", placed, list.size, ms / 1e3);
+    }
+
+    free(steps);
     tlist_free(&list);
     board_free(&board);
 }
 
+void run_replay(int argc, char* argv[]) {
+    if (argc != 1 && argc != 2) {
+        fputs("usage: carcassonne replay move-log-file [start-board-file]\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    // the start board is used as it is in the file, without the auto mode margin
+    sized_board start = { 0, 0 };
+    if (argc == 2) {
+        start.size = board_get_size(argv[1]);
+        start.tiles = board_alloc(start.size);
+        if (!board_parse(argv[1], &start)) {
+            fprintf(stderr, "error parsing board file: %s\n", argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    double begin = ai_clockMs();
+    long moves = movelog_replay(argv[0], argc == 2 ? &start : NULL, stdout);
+    double ms = ai_clockMs() - begin;
+    if (argc == 2) {
+        board_free(&start);
+    }
+    if (moves < 0) {
+        fprintf(stderr, "error replaying move log: %s\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (opts.stats) {
+        fprintf(stderr, "moves: %ld in %.3f s (%.0f/s)\n", moves, ms / 1e3, ms > 0 ? (double)moves / ms * 1e3 : 0.0);
+    }
+}
+
+void run_score_batch(int argc, char* argv[]) {
+    batch_format format = BATCH_CSV;
+    if (opts.format && STR_EQ(opts.format, "json")) {
+        format = BATCH_JSON;
+    } else if (opts.format && !STR_EQ(opts.format, "csv")) {
+        fprintf(stderr, "unknown format: %s\n", opts.format);
+        exit(EXIT_FAILURE);
+    }
+    if (argc < 1) {
+        fputs("usage: carcassonne score-batch board-file|directory|@list-file... [options]\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t count;
+    char** paths = batch_collect(argc, argv, &count);
+    if (!paths) {
+        exit(EXIT_FAILURE);
+    }
+    double start = ai_clockMs();
+    size_t failed = batch_score(paths, count, opts.ai.threads, format, stdout);
+    double ms = ai_clockMs() - start;
+    if (opts.stats) {
+        fprintf(stderr, "boards: %zu, failed: %zu in %.3f s (%.0f/s)\n", count, failed, ms / 1e3,
+                ms > 0 ? (double)count / ms * 1e3 : 0.0);
+    }
+    batch_freePaths(paths, count);
+}
+
+static const struct { const char* cmd; void (*func)(int, char*[]); } cmd_list[] = {
+    { "ab",         run_ab },
+    { "plan",       run_plan },
+    { "replay",     run_replay },
+    { "score-batch", run_score_batch },
+};
+
 void run(int argc, char* argv[]) {
+    // the deadline counts from the start, loading the files is part of the budget
+    double start = ai_clockMs();
+    parse_options(&argc, argv);
+    if (opts.ai.deadlineMs) {
+        opts.ai.deadline = start + (double)opts.ai.deadlineMs;
+    }
+
+    // subcommands get the arguments following their name
+    for (size_t i = 0; argc > 1 && i < ARR_LEN(cmd_list); ++i) {
+        if (STR_EQ(argv[1], cmd_list[i].cmd)) {
+            cmd_list[i].func(argc - 2, argv + 2);
+            return;
+        }
+    }
+
     // argc is always at least 1 since program name is always first argument,
     // if zero additional arguments set mode to INTERACTIVE_NO_TILES,
     // if one set mode to INTERACTIVE,
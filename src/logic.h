@@ -29,6 +29,45 @@ FILE* exit_on_bad_file_open(const char* filename, const char* mode, const char*
  */
 void handle_args(int argc, char* argv[]);
 
+/**
+ * strip recognised options (eg. --top-k 8, --stats) from the arguments,
+ * exits when an option is missing its value.
+ * @param [in,out] argc amount of arguments to program
+ * @param [in,out] argv arguments to the program
+ */
+void parse_options(int* argc, char* argv[]);
+
+/**
+ * a/b harness: plays the pile out with the exhaustive search and with the
+ * top-k ordered search from the same position and prints score and time of both.
+ * @param [in] argc amount of arguments after the subcommand
+ * @param [in] argv tiles-list-file and board-file
+ */
+void run_ab(int argc, char* argv[]);
+
+/**
+ * plan a known deal: the tiles are placed in list order, each chosen by a beam search over the next
+ * --window tiles. prints every step, writes the final board and leaves the passed over tiles in the list.
+ * @param [in] argc amount of arguments after the subcommand
+ * @param [in] argv tiles-list-file and board-file
+ */
+void run_plan(int argc, char* argv[]);
+
+/**
+ * replay a move log written by auto mode with --log and print the score after every move.
+ * @param [in] argc amount of arguments after the subcommand
+ * @param [in] argv move-log-file and optionally the board file the log starts from
+ */
+void run_replay(int argc, char* argv[]);
+
+/**
+ * score many board files on worker threads, print one csv or json line per board
+ * with castle, road and temple subtotals, in the order of the arguments.
+ * @param [in] argc amount of arguments after the subcommand
+ * @param [in] argv board files, directories or @list files
+ */
+void run_score_batch(int argc, char* argv[]);
+
 /**
  * main game loop.
  * @param [in] amount of arguments to program
@@ -0,0 +1,455 @@
+#include "mcts.h"
+#include "frontier.h"
+#include "scheduler.h"
+#include "tile_tables.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ROTATION_MOVES 4
+
+// exploration constant of the UCT formula, rewards are normalized to [0, 1]
+#define MCTS_EXPLORATION 1.0
+// placements the tree itself may add past the root, limits the board margin
+#define MCTS_MAX_DEPTH 16
+// nodes the tree grows to at most, playouts go on from its leaves once it is full
+#define MCTS_MAX_NODES ((size_t)1 << 20)
+
+#define NO_NODE ((size_t)0)
+
+typedef struct {
+    size_t cell;            // row * size + column on the worker boards
+    size_t tileIndex;
+    size_t rotation;
+} mcts_move;
+
+typedef struct {
+    mcts_move m;
+    size_t firstChild;      // NO_NODE if none, the root is never a child
+    size_t nextSibling;
+    size_t moveCount;       // legal moves from the node's position
+    size_t expanded;        // children created so far
+    size_t visits;
+    size_t virtualLoss;     // workers currently playing out below the node
+    double reward;          // sum of rollout scores
+    bool pending;           // created, but its move is not generated yet
+} mcts_node;
+
+typedef struct {
+    const ai_config* config;
+    size_t threads;
+    size_t size;            // side of the worker boards
+    size_t margin;          // offset of the root board on the worker boards
+    mcts_node* nodes;
+    size_t nodeCount;
+    size_t nodeCapacity;
+    size_t iterations;
+    size_t iterationLimit;  // SIZE_MAX when only the time limits the search
+    double minReward, maxReward;
+    double start;
+    bool stop;
+    bool cut;               // stopped by the deadline
+    pthread_mutex_t lock;
+} mcts_tree;
+
+typedef struct {
+    size_t cell;
+    size_t tileIndex;
+    size_t rotation;
+    size_t frontierMark;    // frontier log position before the placement
+} placement;
+
+typedef struct {
+    mcts_tree* tree;
+    sized_board board;
+    // private copy of the pile, tiles are rotated in place while placed
+    tile** pile;
+    size_t pileSize;
+    size_t* typeOf;         // tile_code of every tile
+    size_t* rotations;      // distinct rotations of every tile
+    bool* used;
+    // legal cells by edge constraint, restored exactly on undo so the
+    // order of the moves of a position does not depend on earlier playouts
+    frontier cells;
+    // scratch buffers sized once
+    size_t* reps;
+    size_t* stamp;
+    size_t generation;
+    size_t* draw;
+    size_t* fits;
+    placement* journal;
+    size_t journalSize;
+    size_t* path;
+    scorer s;
+    uint64_t rng;
+    size_t playouts;
+} mcts_worker;
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+
+static void worker_place(mcts_worker* w, size_t cell, size_t tileIndex, size_t rotation) {
+    size_t size = w->tree->size, row = cell / size, column = cell % size;
+    tile* t = w->pile[tileIndex];
+    tile_rotate_amount((rotation_t)rotation, t);
+    w->board.tiles[row][column] = t;
+    w->used[tileIndex] = true;
+    w->journal[w->journalSize++] = (placement){ cell, tileIndex, rotation, frontier_mark(&w->cells) };
+    frontier_place(&w->cells, &w->board, row, column);
+}
+
+static void worker_undo(mcts_worker* w) {
+    placement* p = &w->journal[--w->journalSize];
+    size_t size = w->tree->size;
+    w->board.tiles[p->cell / size][p->cell % size] = NULL;
+    tile_rotate_amount((rotation_t)((ROTATION_MOVES - p->rotation) % ROTATION_MOVES), w->pile[p->tileIndex]);
+    w->used[p->tileIndex] = false;
+    frontier_undo(&w->cells, p->frontierMark);
+}
+
+// counts legal moves of the current position and writes the k-th one to out,
+// identical tiles are counted once
+static size_t worker_moves(mcts_worker* w, size_t k, mcts_move* out) {
+    size_t repCount = 0, count = 0;
+    w->generation++;
+    for(size_t j = 0; j < w->pileSize; j++) {
+        if(!w->used[j] && w->stamp[w->typeOf[j]] != w->generation) {
+            w->stamp[w->typeOf[j]] = w->generation;
+            w->reps[repCount++] = j;
+        }
+    }
+
+    for(size_t r = 0; r < repCount; r++) {
+        size_t j = w->reps[r];
+        size_t code = w->typeOf[j];
+        for(size_t rot = 0; rot < w->rotations[j]; rot++, code = tile_infos[code].rotated) {
+            if(!frontier_fits(&w->cells, tile_infos[code].edges)) continue;
+            uint8_t keys[FRONTIER_MATCHES];
+            frontier_matchingKeys(tile_infos[code].edges, keys);
+            for(size_t m = 0; m < FRONTIER_MATCHES; m++) {
+                size_t cellCount;
+                const size_t* cells = frontier_cells(&w->cells, keys[m], &cellCount);
+                if(out && k >= count && k < count + cellCount) {
+                    *out = (mcts_move){ cells[k - count], j, rot };
+                }
+                count += cellCount;
+            }
+        }
+    }
+    return count;
+}
+
+// places random tiles from the remaining pile, returns the amount placed
+static size_t worker_rollout(mcts_worker* w, size_t horizon) {
+    size_t remaining = 0, placed = 0;
+    for(size_t j = 0; j < w->pileSize; j++) {
+        if(!w->used[j]) w->draw[remaining++] = j;
+    }
+
+    // the game is over once no tile of the pile fits anywhere, the rest would be drawn and discarded
+    while(remaining > 0 && (horizon == 0 || placed < horizon) && frontier_placeable(&w->cells)) {
+        size_t r = (size_t)(next_random(&w->rng) % remaining);
+        size_t j = w->draw[r];
+        w->draw[r] = w->draw[--remaining];
+
+        size_t fitCount = 0, code = w->typeOf[j];
+        for(size_t rot = 0; rot < w->rotations[j]; rot++, code = tile_infos[code].rotated) {
+            if(!frontier_fits(&w->cells, tile_infos[code].edges)) continue;
+            uint8_t keys[FRONTIER_MATCHES];
+            frontier_matchingKeys(tile_infos[code].edges, keys);
+            for(size_t m = 0; m < FRONTIER_MATCHES; m++) {
+                size_t cellCount;
+                const size_t* cells = frontier_cells(&w->cells, keys[m], &cellCount);
+                for(size_t c = 0; c < cellCount; c++) {
+                    w->fits[fitCount++] = cells[c] * ROTATION_MOVES + rot;
+                }
+            }
+        }
+
+        // a tile fitting nowhere is drawn and discarded
+        if(fitCount) {
+            size_t pick = w->fits[next_random(&w->rng) % fitCount];
+            worker_place(w, pick / ROTATION_MOVES, j, pick % ROTATION_MOVES);
+            placed++;
+        }
+    }
+    return placed;
+}
+
+static void worker_init(mcts_worker* w, mcts_tree* tree, const sized_board* root,
+                        const sized_tlist* list, size_t index) {
+    size_t size = tree->size, cells = size * size;
+    memset(w, 0, sizeof(*w));
+    w->tree = tree;
+    w->board = (sized_board){ board_alloc(size), size };
+    board_copy_offsetted(root, (ptrdiff_t)tree->margin, (ptrdiff_t)tree->margin, &w->board);
+
+    w->pileSize = list->size;
+    w->pile = malloc(list->size * sizeof(tile*));
+    w->typeOf = malloc(list->size * sizeof(size_t));
+    w->rotations = malloc(list->size * sizeof(size_t));
+    w->used = calloc(list->size, sizeof(bool));
+    w->reps = malloc(list->size * sizeof(size_t));
+    w->stamp = calloc(TILE_CODES, sizeof(size_t));
+    w->draw = malloc(list->size * sizeof(size_t));
+    w->journal = malloc(list->size * sizeof(placement));
+    w->path = malloc((list->size + 1) * sizeof(size_t));
+    for(size_t j = 0; j < list->size; j++) {
+        tile* t = list->tiles[j];
+        w->pile[j] = tile_alloc_from_tile(t);
+        w->rotations[j] = tile_info_of(t)->rotations;
+        w->typeOf[j] = tile_code(t);
+    }
+
+    w->fits = malloc(cells * ROTATION_MOVES * sizeof(size_t));
+    frontier_init(&w->cells, &w->board);
+    // the frontier counts the cells of every rotation of the pile, placed tiles stay watched
+    // since taking a watch back costs more on every placement than the counts save
+    for(size_t j = 0; j < list->size; j++) {
+        size_t code = w->typeOf[j];
+        for(size_t rot = 0; rot < w->rotations[j]; rot++, code = tile_infos[code].rotated) {
+            frontier_watch(&w->cells, tile_infos[code].edges);
+        }
+    }
+
+    scorer_init(&w->s);
+    scorer_reserve(&w->s, cells * 8);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    w->rng = ((uint64_t)now.tv_nsec << 16) ^ (uint64_t)now.tv_sec ^ ((uint64_t)(index + 1) * 0x9E3779B97F4A7C15ULL);
+    if(w->rng == 0) w->rng = 1;
+}
+
+static void worker_free(mcts_worker* w) {
+    board_free(&w->board);
+    for(size_t j = 0; j < w->pileSize; j++) {
+        tile_free(w->pile[j]);
+        free(w->pile[j]);
+    }
+    free(w->pile);
+    free(w->typeOf);
+    free(w->rotations);
+    free(w->used);
+    free(w->reps);
+    free(w->stamp);
+    free(w->draw);
+    free(w->journal);
+    free(w->path);
+    frontier_free(&w->cells);
+    free(w->fits);
+    scorer_free(&w->s);
+}
+
+static double node_uct(const mcts_tree* tree, const mcts_node* parent, const mcts_node* child) {
+    double n = (double)(child->visits + child->virtualLoss);
+    if(n == 0) {
+        return INFINITY;
+    }
+    // virtual loss counts as visits with the worst reward seen
+    double mean = (child->reward + (double)child->virtualLoss * tree->minReward) / n;
+    double range = tree->maxReward - tree->minReward;
+    double q = range > 0 ? (mean - tree->minReward) / range : 0.5;
+    double parentN = (double)(parent->visits + parent->virtualLoss);
+    return q + MCTS_EXPLORATION * sqrt(log(parentN + 1) / n);
+}
+
+// walks down the tree under the lock, returns path length, *created is set
+// when the last node of the path was just created and needs its move generated
+static size_t tree_select(mcts_tree* tree, size_t* path, bool* created) {
+    size_t depth = 0, node = 0;
+    *created = false;
+    path[depth++] = node;
+    tree->nodes[node].virtualLoss++;
+
+    while(true) {
+        mcts_node* n = &tree->nodes[node];
+        if(n->moveCount == 0 || depth > MCTS_MAX_DEPTH) {
+            break;
+        }
+        if(n->expanded < n->moveCount && tree->nodeCount < tree->nodeCapacity) {
+            size_t child = tree->nodeCount++;
+            tree->nodes[child] = (mcts_node){ .m = { n->expanded, 0, 0 }, .nextSibling = n->firstChild,
+                                              .virtualLoss = 1, .pending = true };
+            n->firstChild = child;
+            n->expanded++;
+            path[depth++] = child;
+            *created = true;
+            break;
+        }
+
+        size_t best = NO_NODE;
+        double bestValue = -INFINITY;
+        for(size_t c = n->firstChild; c != NO_NODE; c = tree->nodes[c].nextSibling) {
+            if(tree->nodes[c].pending) continue;
+            double value = node_uct(tree, n, &tree->nodes[c]);
+            if(value > bestValue) {
+                bestValue = value;
+                best = c;
+            }
+        }
+        if(best == NO_NODE) {
+            break;
+        }
+        node = best;
+        tree->nodes[node].virtualLoss++;
+        path[depth++] = node;
+    }
+    return depth;
+}
+
+static void worker_run(void* arg, size_t index) {
+    (void)index;
+    mcts_worker* w = arg;
+    mcts_tree* tree = w->tree;
+    size_t horizon = tree->config->horizon;
+
+    while(true) {
+        pthread_mutex_lock(&tree->lock);
+        double now = ai_clockMs();
+        // the budget is checked from the second iteration on, the first one always gives a move
+        if(!tree->stop && tree->iterations > 0 && (tree->iterations >= tree->iterationLimit
+                || (tree->config->timeMs && now - tree->start >= (double)tree->config->timeMs))) {
+            tree->stop = true;
+        }
+        // a deadline still lets the first playout finish to have a move to answer with
+        if(!tree->stop && tree->config->deadline > 0 && now >= tree->config->deadline && tree->nodes[0].visits > 0) {
+            tree->stop = true;
+            tree->cut = true;
+        }
+        if(tree->stop) {
+            pthread_mutex_unlock(&tree->lock);
+            break;
+        }
+        tree->iterations++;
+        bool created;
+        size_t depth = tree_select(tree, w->path, &created);
+        pthread_mutex_unlock(&tree->lock);
+
+        // replay the path, moves of existing nodes are immutable once ready
+        size_t known = created ? depth - 1 : depth;
+        for(size_t d = 1; d < known; d++) {
+            mcts_move* m = &tree->nodes[w->path[d]].m;
+            worker_place(w, m->cell, m->tileIndex, m->rotation);
+        }
+        mcts_move generated = { 0, 0, 0 };
+        size_t childMoves = 0;
+        if(created) {
+            // the pending node holds the index of its move among the parent's moves
+            worker_moves(w, tree->nodes[w->path[depth - 1]].m.cell, &generated);
+            worker_place(w, generated.cell, generated.tileIndex, generated.rotation);
+            childMoves = worker_moves(w, SIZE_MAX, NULL);
+        }
+
+        size_t placed = worker_rollout(w, horizon);
+        double reward = (double)scorer_score(&w->s, &w->board);
+        while(placed--) {
+            worker_undo(w);
+        }
+        while(w->journalSize) {
+            worker_undo(w);
+        }
+        w->playouts++;
+
+        pthread_mutex_lock(&tree->lock);
+        if(created) {
+            mcts_node* child = &tree->nodes[w->path[depth - 1]];
+            child->m = generated;
+            child->moveCount = childMoves;
+            child->pending = false;
+        }
+        if(reward < tree->minReward) tree->minReward = reward;
+        if(reward > tree->maxReward) tree->maxReward = reward;
+        for(size_t d = 0; d < depth; d++) {
+            mcts_node* n = &tree->nodes[w->path[d]];
+            n->visits++;
+            n->reward += reward;
+            n->virtualLoss--;
+        }
+        pthread_mutex_unlock(&tree->lock);
+    }
+}
+
+move* mcts_search(sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats) {
+    if(list->size == 0) {
+        return NULL;
+    }
+    mcts_tree tree;
+    memset(&tree, 0, sizeof(tree));
+    tree.config = config;
+    tree.threads = config->threads;
+    if(tree.threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        tree.threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    size_t reach = MCTS_MAX_DEPTH + (config->horizon ? config->horizon : list->size);
+    tree.margin = reach < list->size ? reach : list->size;
+    tree.size = board->size + 2 * tree.margin;
+    // without a node budget a time limit alone ends the search
+    bool timed = config->timeMs || config->deadline > 0;
+    tree.iterationLimit = config->nodes ? config->nodes : timed ? SIZE_MAX : 1;
+    tree.nodeCapacity = (tree.iterationLimit < MCTS_MAX_NODES ? tree.iterationLimit : MCTS_MAX_NODES) + 1;
+    tree.nodes = malloc(tree.nodeCapacity * sizeof(mcts_node));
+    tree.nodes[0] = (mcts_node){ .firstChild = NO_NODE };
+    tree.nodeCount = 1;
+    tree.minReward = INFINITY;
+    tree.maxReward = -INFINITY;
+    pthread_mutex_init(&tree.lock, NULL);
+    tree.start = ai_clockMs();
+
+    mcts_worker* workers = malloc(tree.threads * sizeof(mcts_worker));
+    for(size_t i = 0; i < tree.threads; i++) {
+        worker_init(&workers[i], &tree, board, list, i);
+    }
+    tree.nodes[0].moveCount = worker_moves(&workers[0], SIZE_MAX, NULL);
+
+    move* best = NULL;
+    if(tree.nodes[0].moveCount > 0) {
+        // the playout loops run as tasks, each until the tree stops
+        scheduler* s = scheduler_shared(config->threads);
+        scheduler_group g = SCHEDULER_GROUP_INIT;
+        for(size_t i = 0; i < tree.threads; i++) {
+            scheduler_spawn(s, &g, worker_run, &workers[i]);
+        }
+        scheduler_wait(s, &g);
+
+        // answer with the most visited child of the root
+        size_t bestNode = NO_NODE;
+        for(size_t c = tree.nodes[0].firstChild; c != NO_NODE; c = tree.nodes[c].nextSibling) {
+            if(!tree.nodes[c].pending && tree.nodes[c].visits
+                    && (bestNode == NO_NODE || tree.nodes[c].visits > tree.nodes[bestNode].visits)) {
+                bestNode = c;
+            }
+        }
+        if(bestNode != NO_NODE) {
+            mcts_node* n = &tree.nodes[bestNode];
+            best = move_default();
+            move_set(best, (int)(n->m.cell / tree.size - tree.margin), (int)(n->m.cell % tree.size - tree.margin),
+                     (int)n->m.tileIndex, (int)n->m.rotation, (int)lround(n->reward / (double)n->visits));
+        }
+    }
+
+    if(stats) {
+        for(size_t i = 0; i < tree.threads; i++) {
+            stats->playouts += workers[i].playouts;
+        }
+        stats->seconds += (ai_clockMs() - tree.start) / 1e3;
+        if(tree.cut) stats->cutoffs++;
+    }
+    for(size_t i = 0; i < tree.threads; i++) {
+        worker_free(&workers[i]);
+    }
+    free(workers);
+    free(tree.nodes);
+    pthread_mutex_destroy(&tree.lock);
+    return best;
+}
@@ -0,0 +1,27 @@
+#ifndef MCTS_H
+#define MCTS_H
+/** @file mcts.h */
+
+#include "ai.h"
+
+/**
+* Finds a move by Monte Carlo tree search.
+* The tree is searched with UCT over (cell, tile, rotation) moves by
+* config->threads workers running as tasks of the shared scheduler, each leaf is valued by a random rollout drawing
+* up to config->horizon tiles from the remaining pile. Workers share the tree
+* under a lock and mark their path with a virtual loss while they play out.
+* Every worker owns one preallocated board, pile copy and scorer,
+* so playouts do not allocate.
+* The search stops after config->nodes iterations, config->timeMs or at
+* config->deadline, whichever comes first, but not before one iteration is done.
+* With config->nodes 0 only the time limits count, without them a single iteration is run.
+* The tree grows by one node per iteration up to a fixed size
+* @param [in] game board
+* @param [in] list with available tiles
+* @param [in] search settings
+* @param [out] playouts and search time are added, may be NULL
+* @return most visited move, NULL if there is none
+*/
+move* mcts_search(sized_board* board, sized_tlist* list, const ai_config* config, ai_stats* stats);
+
+#endif
@@ -0,0 +1,32 @@
+#include "morton.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void morton_init(morton_board* m) {
+    memset(m, 0, sizeof(*m));
+}
+
+void morton_fromBoard(morton_board* m, const sized_board* board) {
+    m->size = board->size;
+    m->side = 1;
+    while (m->side < board->size) {
+        m->side *= 2;
+    }
+    if (m->side * m->side > m->capacity) {
+        free(m->cells);
+        m->capacity = m->side * m->side;
+        m->cells = malloc(m->capacity * sizeof(tile*));
+    }
+    memset(m->cells, 0, m->side * m->side * sizeof(tile*));
+    for (size_t i = 0; i < board->size; i++) {
+        for (size_t j = 0; j < board->size; j++) {
+            morton_place(m, i, j, board->tiles[i][j]);
+        }
+    }
+}
+
+void morton_free(morton_board* m) {
+    free(m->cells);
+    morton_init(m);
+}
@@ -3,14 +3,6 @@
 #include <stdbool.h>
 #include <stdio.h>
 
-struct move {
-    int row;
-    int column;
-    int tileIndex;
-    int rotation;
-    int score;
-};
-
 move* move_new(int row, int col,int index, int rotation) {
     move* self = malloc(sizeof(move)); 
     self->row = row;
@@ -89,3 +81,26 @@ bool move_isEqual(move* self, move* m) {
 void move_print(move* self) {
     printf("Tile with index %i, rotated by %i dergees is placed at point (%i,%i) produces final score of %i\n",self->tileIndex,(self->rotation)*90,self->row,self->column,self->score);
 }
+
+void move_buffer_init(move_buffer* buffer) {
+    buffer->records = NULL;
+    buffer->count = 0;
+    buffer->capacity = 0;
+}
+
+void move_buffer_clear(move_buffer* buffer) {
+    buffer->count = 0;
+}
+
+void move_buffer_push(move_buffer* buffer, int row, int column, int index, int rotation) {
+    if (buffer->count == buffer->capacity) {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 64;
+        buffer->records = realloc(buffer->records, buffer->capacity * sizeof(move_record));
+    }
+    buffer->records[buffer->count++] = (move_record){ row, column, index, rotation };
+}
+
+void move_buffer_free(move_buffer* buffer) {
+    free(buffer->records);
+    move_buffer_init(buffer);
+}
@@ -2,8 +2,44 @@
 #define MOVE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-typedef struct move move;
+/**
+* placement of a tile with the score it reaches, a plain value that can live in arrays
+*/
+typedef struct move {
+    int row;
+    int column;
+    int tileIndex;
+    int rotation;
+    int score;
+} move;
+
+/**
+* candidate placement in a flat buffer, a bare cell has tile and rotation -1
+*/
+typedef struct {
+    int32_t row;
+    int32_t column;
+    int32_t tileIndex;
+    int32_t rotation;
+} move_record;
+
+/**
+* growable array of candidates filled by move generation,
+* cleared and refilled by the caller so iterating needs no allocation once it has grown
+*/
+typedef struct {
+    move_record* records;
+    size_t count;
+    size_t capacity;
+} move_buffer;
+
+void move_buffer_init(move_buffer* buffer);
+void move_buffer_clear(move_buffer* buffer);
+void move_buffer_push(move_buffer* buffer, int row, int column, int index, int rotation);
+void move_buffer_free(move_buffer* buffer);
 
 move* move_default(void);
 move* move_new(int row, int col,int index, int rotation);
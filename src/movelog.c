@@ -0,0 +1,196 @@
+#include "movelog.h"
+#include "region.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// largest board a replay allocates cells for
+#define REPLAY_MAX_CELLS ((size_t)1 << 28)
+
+typedef struct {
+    long minRow, minColumn, maxRow, maxColumn;
+    bool any;
+} extent;
+
+static void extent_add(extent* e, long row, long column) {
+    if (!e->any) {
+        *e = (extent){ row, column, row, column, true };
+        return;
+    }
+    if (row < e->minRow) e->minRow = row;
+    if (row > e->maxRow) e->maxRow = row;
+    if (column < e->minColumn) e->minColumn = column;
+    if (column > e->maxColumn) e->maxColumn = column;
+}
+
+static void put_int16(uint8_t* p, int value) {
+    uint16_t v = (uint16_t)(int16_t)value;
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static int get_int16(const uint8_t* p) {
+    return (int16_t)(uint16_t)(p[0] | p[1] << 8);
+}
+
+bool movelog_append(const char* filename, const tile* t, rotation_t rotation, int row, int column) {
+    if (row < INT16_MIN || row > INT16_MAX || column < INT16_MIN || column > INT16_MAX) {
+        return false;
+    }
+    uint8_t buff[MOVELOG_RECORD_SIZE];
+    buff[0] = tile_info_of(t)->edges;
+    buff[1] = (uint8_t)((unsigned)t->mod | (unsigned)rotation << 3);
+    put_int16(&buff[2], row);
+    put_int16(&buff[4], column);
+
+    FILE* file;
+    if ((file = fopen(filename, "ab")) == 0) {
+        return false;
+    }
+    bool written = fwrite(buff, 1, sizeof(buff), file) == sizeof(buff);
+    return fclose(file) == 0 && written;
+}
+
+bool movelog_read(FILE* file, movelog_record* record, bool* error) {
+    uint8_t buff[MOVELOG_RECORD_SIZE];
+    size_t read = fread(buff, 1, sizeof(buff), file);
+    bool bad = read != 0 && read != sizeof(buff);
+    if (read == sizeof(buff)) {
+        unsigned mod = buff[1] & 7u, rotation = buff[1] >> 3;
+        bad = mod > CITY || rotation > ROT_270;
+        for (unsigned d = 0; d < 4; d++) {
+            bad |= ((buff[0] >> (2 * d)) & 3u) > FIELD;
+        }
+        *record = (movelog_record){ buff[0], (modifier)mod, (rotation_t)rotation, get_int16(&buff[2]), get_int16(&buff[4]) };
+    }
+    if (error) {
+        *error = bad;
+    }
+    return read == sizeof(buff) && !bad;
+}
+
+size_t movelog_placedCode(const movelog_record* record) {
+    size_t pattern = 0;
+    for (unsigned d = 0; d < 4; d++) {
+        pattern = pattern * 3 + ((record->edges >> (2 * d)) & 3u);
+    }
+    size_t code = pattern * 5 + (size_t)record->mod;
+    for (unsigned r = 0; r < (unsigned)record->rotation; r++) {
+        code = tile_infos[code].rotated;
+    }
+    return code;
+}
+
+// position of the next move in the frame of the first board file: the first move is made
+// on the given board, the later ones on the trimmed board starting at the top left tile
+static void record_position(const movelog_record* record, const extent* placed, size_t index,
+                            long* row, long* column) {
+    long frameRow = index > 0 && placed->any ? placed->minRow : 0;
+    long frameColumn = index > 0 && placed->any ? placed->minColumn : 0;
+    *row = frameRow + record->row;
+    *column = frameColumn + record->column;
+}
+
+// the board auto mode scores the next move on: the board file with a margin of 1 around it,
+// the first one is the given board, the later ones the square trimmed to the tiles placed
+static void set_frame(region_tracker* r, const extent* all, const sized_board* start, const extent* placed, size_t index) {
+    long top = -1, left = -1, size = start ? (long)start->size + 2 : 0;
+    if (index > 0) {
+        long height = placed->maxRow - placed->minRow + 1, width = placed->maxColumn - placed->minColumn + 1;
+        top = placed->minRow - 1;
+        left = placed->minColumn - 1;
+        size = (height > width ? height : width) + 2;
+    }
+    // the tracker starts one row and column before the extent of the game
+    size_t row = (size_t)(top - all->minRow + 1), column = (size_t)(left - all->minColumn + 1);
+    size_t bottom = row + (size_t)size, right = column + (size_t)size;
+    region_setFrame(r, row, column, bottom < r->rows ? bottom : r->rows, right < r->columns ? right : r->columns);
+}
+
+// writes a score and a newline, faster than printf for long replays
+static void emit_score(FILE* out, int value) {
+    char buff[16];
+    char* p = buff + sizeof(buff);
+    unsigned v = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+    *--p = '\n';
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    if (value < 0) {
+        *--p = '-';
+    }
+    fwrite(p, 1, (size_t)(buff + sizeof(buff) - p), out);
+}
+
+long movelog_replay(const char* filename, const sized_board* start, FILE* out) {
+    FILE* file;
+    if ((file = fopen(filename, "rb")) == 0) {
+        return -1;
+    }
+    setvbuf(file, NULL, _IOFBF, (size_t)1 << 16);
+
+    // first pass: extent of the whole game
+    extent placed = { 0 };
+    for (size_t i = 0; start && i < start->size; i++) {
+        for (size_t j = 0; j < start->size; j++) {
+            if (start->tiles[i][j]) extent_add(&placed, (long)i, (long)j);
+        }
+    }
+    extent all = placed;
+    movelog_record record;
+    bool error = false;
+    size_t moves = 0;
+    long row, column;
+    while (movelog_read(file, &record, &error)) {
+        record_position(&record, &placed, moves++, &row, &column);
+        extent_add(&placed, row, column);
+        extent_add(&all, row, column);
+    }
+    if (error || !all.any) {
+        fclose(file);
+        return error ? -1 : 0;
+    }
+    // a margin of 1 keeps every tile off the border of the tracker, the frames bring the border of the boards back
+    size_t rows = (size_t)(all.maxRow - all.minRow + 3), columns = (size_t)(all.maxColumn - all.minColumn + 3);
+    if (rows > REPLAY_MAX_CELLS / columns) {
+        fclose(file);
+        return -1;
+    }
+
+    // second pass: place the tiles, same positions as before
+    region_tracker r;
+    region_init(&r, rows, columns);
+    placed = (extent){ 0 };
+    for (size_t i = 0; start && i < start->size; i++) {
+        for (size_t j = 0; j < start->size; j++) {
+            if (start->tiles[i][j]) {
+                extent_add(&placed, (long)i, (long)j);
+                region_place(&r, (size_t)((long)i - all.minRow + 1), (size_t)((long)j - all.minColumn + 1),
+                             tile_code(start->tiles[i][j]));
+            }
+        }
+    }
+    rewind(file);
+    long replayed = 0;
+    while (movelog_read(file, &record, NULL)) {
+        if (start || replayed > 0) {
+            set_frame(&r, &all, start, &placed, (size_t)replayed);
+        }
+        record_position(&record, &placed, (size_t)replayed, &row, &column);
+        extent_add(&placed, row, column);
+        size_t code = movelog_placedCode(&record);
+        size_t i = (size_t)(row - all.minRow + 1), j = (size_t)(column - all.minColumn + 1);
+        if (!region_fits(&r, i, j, code)) {
+            fprintf(stderr, "move %ld does not fit at %ld %ld\n", replayed + 1, row, column);
+            replayed = -1;
+            break;
+        }
+        emit_score(out, region_place(&r, i, j, code));
+        replayed++;
+    }
+    region_free(&r);
+    fclose(file);
+    return replayed;
+}
@@ -0,0 +1,70 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+/** @file movelog.h */
+
+#include "board.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** @addtogroup MoveLog
+* append-only log of the moves of a game, 6 bytes per move:
+* packed edges of the tile as it was in the list (see tile_info::edges),
+* modifier | rotation << 3, then row and column as little endian int16.
+* coordinates are relative to the board file the move was made on, so -1 is a move
+* into the margin above or left of it. auto mode trims the board after every move,
+* so the board file of a move starts at the top left tile of the previous ones
+* @{
+*/
+
+/** bytes of one record */
+#define MOVELOG_RECORD_SIZE 6
+
+typedef struct {
+    uint8_t edges;
+    modifier mod;
+    rotation_t rotation;
+    int row;
+    int column;
+} movelog_record;
+/** @} */
+
+/**
+* append one move to the log, the file is created if needed.
+* @param [in] filename log file
+* @param [in] t tile as it was in the list, before rotating it
+* @param [in] rotation rotation of the move
+* @param [in] row row relative to the board file
+* @param [in] column column relative to the board file
+* @return success of writing
+*/
+bool movelog_append(const char* filename, const tile* t, rotation_t rotation, int row, int column);
+
+/**
+* read the next record of a log.
+* @param [in] file log stream
+* @param [out] record decoded record
+* @param [out] error set when the record is truncated or not valid, may be NULL
+* @return false at the end of the log or on error
+*/
+bool movelog_read(FILE* file, movelog_record* record, bool* error);
+
+/**
+* tile code of the record's tile after its rotation.
+* @param [in] record record
+* @return tile_code of the placed tile
+*/
+size_t movelog_placedCode(const movelog_record* record);
+
+/**
+* replay a log: apply the moves one by one with incremental scoring and write
+* the score after every move, one per line. no boards are built in between,
+* the log is read twice, first to find the extent of the game.
+* @param [in] filename log file
+* @param [in] start board the log starts from, may be NULL for an empty board
+* @param [out] out stream for the scores
+* @return amount of moves replayed, -1 on a bad log or a move that does not fit
+*/
+long movelog_replay(const char* filename, const sized_board* start, FILE* out);
+
+#endif
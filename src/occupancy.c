@@ -0,0 +1,208 @@
+#include "occupancy.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// widest vector the row length is rounded to, so a load never leaves the row
+#define MAX_LANES 4
+
+#if defined(__AVX2__) && !defined(OCCUPANCY_SCALAR)
+#include <immintrin.h>
+typedef __m256i lane_t;
+#define LANES 4
+#define lane_load(p) _mm256_loadu_si256((const __m256i*)(const void*)(p))
+#define lane_store(p, v) _mm256_storeu_si256((__m256i*)(void*)(p), (v))
+#define lane_and(a, b) _mm256_and_si256((a), (b))
+#define lane_or(a, b) _mm256_or_si256((a), (b))
+#define lane_xor(a, b) _mm256_xor_si256((a), (b))
+#define lane_shl(a, n) _mm256_slli_epi64((a), (n))
+#define lane_shr(a, n) _mm256_srli_epi64((a), (n))
+#elif defined(__SSE2__) && !defined(OCCUPANCY_SCALAR)
+#include <emmintrin.h>
+typedef __m128i lane_t;
+#define LANES 2
+#define lane_load(p) _mm_loadu_si128((const __m128i*)(const void*)(p))
+#define lane_store(p, v) _mm_storeu_si128((__m128i*)(void*)(p), (v))
+#define lane_and(a, b) _mm_and_si128((a), (b))
+#define lane_or(a, b) _mm_or_si128((a), (b))
+#define lane_xor(a, b) _mm_xor_si128((a), (b))
+#define lane_shl(a, n) _mm_slli_epi64((a), (n))
+#define lane_shr(a, n) _mm_srli_epi64((a), (n))
+#else
+typedef uint64_t lane_t;
+#define LANES 1
+#define lane_load(p) (*(p))
+#define lane_store(p, v) (*(p) = (v))
+#define lane_and(a, b) ((a) & (b))
+#define lane_or(a, b) ((a) | (b))
+#define lane_xor(a, b) ((a) ^ (b))
+#define lane_shl(a, n) ((a) << (n))
+#define lane_shr(a, n) ((a) >> (n))
+#endif
+
+static int popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555u);
+    x = (x & 0x3333333333333333u) + ((x >> 2) & 0x3333333333333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+    return (int)((x * 0x0101010101010101u) >> 56);
+#endif
+}
+
+void occupancy_init(occupancy* o) {
+    memset(o, 0, sizeof(*o));
+}
+
+void occupancy_reset(occupancy* o, size_t size) {
+    size_t words = (size + 63) / 64;
+    o->size = size;
+    o->stride = (words + MAX_LANES - 1) / MAX_LANES * MAX_LANES + 2;
+    size_t needed = (size + 2) * o->stride;
+    if (needed > o->capacity) {
+        free(o->bits);
+        o->capacity = needed;
+        o->bits = malloc(needed * sizeof(uint64_t));
+    }
+    memset(o->bits, 0, needed * sizeof(uint64_t));
+}
+
+void occupancy_free(occupancy* o) {
+    free(o->bits);
+    occupancy_init(o);
+}
+
+void occupancy_fromBoard(occupancy* occupied, occupancy* temples, const sized_board* board) {
+    occupancy_reset(occupied, board->size);
+    if (temples) {
+        occupancy_reset(temples, board->size);
+    }
+    for (size_t i = 0; i < board->size; i++) {
+        for (size_t j = 0; j < board->size; j++) {
+            const tile* t = board->tiles[i][j];
+            if (t) {
+                occupancy_set(occupied, i, j);
+                if (temples && tile_hasTemple(t)) {
+                    occupancy_set(temples, i, j);
+                }
+            }
+        }
+    }
+}
+
+// bit of a padded row, index 64 is column 0
+static int bit_at(const uint64_t* row, size_t index) {
+    return (int)((row[index / 64] >> (index % 64)) & 1u);
+}
+
+int occupancy_neighbours(const occupancy* o, size_t row, size_t column) {
+    size_t index = column + 64;
+    int count = -bit_at(o->bits + (row + 1) * o->stride, index);
+    for (size_t r = row; r < row + 3; r++) {
+        const uint64_t* p = o->bits + r * o->stride;
+        count += bit_at(p, index - 1) + bit_at(p, index) + bit_at(p, index + 1);
+    }
+    return count;
+}
+
+static inline void full_add(lane_t a, lane_t b, lane_t c, lane_t* sum, lane_t* carry) {
+    lane_t ab = lane_xor(a, b);
+    *sum = lane_xor(ab, c);
+    *carry = lane_or(lane_and(a, b), lane_and(ab, c));
+}
+
+// counts the eight neighbours of the cells of LANES words, up, mid and down point at the word
+// in the rows above, of and below the cells, the words beside them bring the bits across word borders
+static inline void neighbour_planes(const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                                    lane_t planes[OCCUPANCY_PLANES]) {
+    lane_t u = lane_load(up), m = lane_load(mid), d = lane_load(down);
+    lane_t uw = lane_or(lane_shl(u, 1), lane_shr(lane_load(up - 1), 63));
+    lane_t ue = lane_or(lane_shr(u, 1), lane_shl(lane_load(up + 1), 63));
+    lane_t mw = lane_or(lane_shl(m, 1), lane_shr(lane_load(mid - 1), 63));
+    lane_t me = lane_or(lane_shr(m, 1), lane_shl(lane_load(mid + 1), 63));
+    lane_t dw = lane_or(lane_shl(d, 1), lane_shr(lane_load(down - 1), 63));
+    lane_t de = lane_or(lane_shr(d, 1), lane_shl(lane_load(down + 1), 63));
+
+    // ones from three full adders and a half adder, twos and fours from their carries
+    lane_t s1, c1, s2, c2, s4, c4, s5, c5;
+    full_add(uw, u, ue, &s1, &c1);
+    full_add(mw, me, dw, &s2, &c2);
+    lane_t s3 = lane_xor(d, de), c3 = lane_and(d, de);
+    full_add(s1, s2, s3, &s4, &c4);
+    full_add(c1, c2, c3, &s5, &c5);
+    lane_t c6 = lane_and(s5, c4);
+    planes[0] = s4;
+    planes[1] = lane_xor(s5, c4);
+    planes[2] = lane_xor(c5, c6);
+    planes[3] = lane_and(c5, c6);
+}
+
+void occupancy_countNeighbours(const occupancy* o, occupancy planes[static OCCUPANCY_PLANES]) {
+    for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+        occupancy_reset(&planes[k], o->size);
+    }
+    size_t words = o->stride - 2;
+    for (size_t r = 0; r < o->size; r++) {
+        const uint64_t* mid = o->bits + (r + 1) * o->stride;
+        size_t out = (r + 1) * o->stride;
+        for (size_t w = 1; w <= words; w += LANES) {
+            lane_t counts[OCCUPANCY_PLANES];
+            neighbour_planes(mid - o->stride + w, mid + w, mid + o->stride + w, counts);
+            for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+                lane_store(planes[k].bits + out + w, counts[k]);
+            }
+        }
+        // the padding has to stay empty, the sweep also counted the cells past the last column
+        size_t tail = o->size % 64;
+        if (tail) {
+            for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+                planes[k].bits[out + 1 + o->size / 64] &= ((uint64_t)1 << tail) - 1;
+            }
+        }
+        for (size_t w = 2 + (o->size - 1) / 64; w <= words; w++) {
+            for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+                planes[k].bits[out + w] = 0;
+            }
+        }
+    }
+}
+
+int occupancy_countAt(const occupancy planes[static OCCUPANCY_PLANES], size_t row, size_t column) {
+    int count = 0;
+    for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+        count |= (int)occupancy_get(&planes[k], row, column) << k;
+    }
+    return count;
+}
+
+int occupancy_templeScore(const occupancy* occupied, const occupancy* temples) {
+    size_t words = occupied->stride - 2;
+    int score = 0;
+    for (size_t r = 0; r < occupied->size; r++) {
+        const uint64_t* mid = occupied->bits + (r + 1) * occupied->stride;
+        const uint64_t* marked = temples->bits + (r + 1) * temples->stride;
+        for (size_t w = 1; w <= words; w += LANES) {
+            uint64_t any = 0;
+            for (size_t l = 0; l < LANES; l++) {
+                any |= marked[w + l];
+            }
+            if (!any) {
+                continue;
+            }
+            lane_t counts[OCCUPANCY_PLANES];
+            neighbour_planes(mid - occupied->stride + w, mid + w, mid + occupied->stride + w, counts);
+            for (size_t k = 0; k < OCCUPANCY_PLANES; k++) {
+                uint64_t plane[LANES];
+                lane_store(plane, counts[k]);
+                for (size_t l = 0; l < LANES; l++) {
+                    score += popcount64(plane[l] & marked[w + l]) << k;
+                }
+            }
+            for (size_t l = 0; l < LANES; l++) {
+                score += popcount64(marked[w + l]);
+            }
+        }
+    }
+    return score;
+}
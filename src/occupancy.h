@@ -0,0 +1,101 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+/** @file occupancy.h */
+
+#include "board.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** @addtogroup Occupancy
+* bitmap of the cells of a board, one bit per cell.
+* every row is padded with a zero word on both sides and there is a zero row above and below
+* the board, so the 3x3 block around any cell can be read without bounds checks.
+* neighbour counts are computed 64 cells per word with bit-sliced adders,
+* several words at once with SSE2 or AVX2 when the compiler targets them
+* (define OCCUPANCY_SCALAR to force the plain 64 bit version)
+* @{
+*/
+
+/** bit planes of a neighbour count, 0 to 8 needs 4 bits */
+#define OCCUPANCY_PLANES 4
+
+typedef struct {
+    size_t size;        // side of the board
+    size_t stride;      // words per row with the padding
+    uint64_t* bits;     // size + 2 rows, cell (row, column) is bit column + 64 of row row + 1
+    size_t capacity;    // words allocated
+} occupancy;
+/** @} */
+
+/**
+* initializes an empty bitmap without memory.
+* @param [out] o bitmap
+*/
+void occupancy_init(occupancy* o);
+
+/**
+* sizes the bitmap for a board and clears every cell, keeps the memory when it is big enough.
+* @param [in,out] o bitmap
+* @param [in] size side of the board
+*/
+void occupancy_reset(occupancy* o, size_t size);
+
+/**
+* frees the memory of the bitmap.
+* @param [in,out] o bitmap
+*/
+void occupancy_free(occupancy* o);
+
+/**
+* marks the tiles of a board, and the temples in a second bitmap.
+* @param [out] occupied cells with a tile
+* @param [out] temples cells with a temple, may be NULL
+* @param [in] board board
+*/
+void occupancy_fromBoard(occupancy* occupied, occupancy* temples, const sized_board* board);
+
+static inline void occupancy_set(occupancy* o, size_t row, size_t column) {
+    o->bits[(row + 1) * o->stride + 1 + column / 64] |= (uint64_t)1 << (column % 64);
+}
+
+static inline bool occupancy_get(const occupancy* o, size_t row, size_t column) {
+    return (o->bits[(row + 1) * o->stride + 1 + column / 64] >> (column % 64)) & 1u;
+}
+
+/**
+* marked cells among the eight around a cell, one cell at a time.
+* @param [in] o bitmap
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @return amount of marked neighbours
+*/
+int occupancy_neighbours(const occupancy* o, size_t row, size_t column);
+
+/**
+* marked neighbours of every cell of the board in one sweep.
+* plane k holds bit k of the count of each cell
+* @param [in] o bitmap
+* @param [out] planes bit planes, reset to the size of the bitmap
+*/
+void occupancy_countNeighbours(const occupancy* o, occupancy planes[static OCCUPANCY_PLANES]);
+
+/**
+* read a count out of the planes of occupancy_countNeighbours.
+* @param [in] planes bit planes
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @return amount of marked neighbours
+*/
+int occupancy_countAt(const occupancy planes[static OCCUPANCY_PLANES], size_t row, size_t column);
+
+/**
+* points of all temples: each scores 1 plus its occupied neighbours.
+* the counts are summed a word at a time, words without a temple are skipped
+* @param [in] occupied cells with a tile
+* @param [in] temples cells with a temple, same size
+* @return sum of the temple scores
+*/
+int occupancy_templeScore(const occupancy* occupied, const occupancy* temples);
+
+#endif
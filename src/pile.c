@@ -0,0 +1,105 @@
+#include "pile.h"
+#include "tile_tables.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__) && !defined(PILE_SCALAR)
+#include <immintrin.h>
+#elif defined(__SSE2__) && !defined(PILE_SCALAR)
+#include <emmintrin.h>
+#endif
+
+static int popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555u);
+    x = (x & 0x3333333333333333u) + ((x >> 2) & 0x3333333333333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+    return (int)((x * 0x0101010101010101u) >> 56);
+#endif
+}
+
+void pile_init(tile_pile* p) {
+    memset(p, 0, sizeof(*p));
+}
+
+void pile_fromList(tile_pile* p, const sized_tlist* list) {
+    if (list->size > p->capacity) {
+        free(p->edges);
+        free(p->mods);
+        p->capacity = list->size;
+        p->edges = malloc(p->capacity);
+        p->mods = malloc(p->capacity);
+    }
+    p->size = list->size;
+    for (size_t j = 0; j < list->size; j++) {
+        p->edges[j] = tile_info_of(list->tiles[j])->edges;
+        p->mods[j] = (uint8_t)list->tiles[j]->mod;
+    }
+}
+
+void pile_free(tile_pile* p) {
+    free(p->edges);
+    free(p->mods);
+    pile_init(p);
+}
+
+size_t pile_fitting(const tile_pile* p, uint8_t constraint, unsigned rotation, uint64_t* bits) {
+    // a tile turned clockwise fits when its edges as listed fit the constraint turned back,
+    // one quarter turn moves every side 2 bits up
+    unsigned shift = 2u * (rotation & 3u);
+    uint8_t key = (uint8_t)((constraint >> shift | constraint << (8u - shift)) & 0xFFu);
+    unsigned any = (unsigned)(key & (key >> 1)) & 0x55u;
+    uint8_t mask = (uint8_t)~(any | any << 1), want = key & mask;
+
+    size_t words = (p->size + 63) / 64, j = 0;
+    memset(bits, 0, words * sizeof(uint64_t));
+#if defined(__AVX2__) && !defined(PILE_SCALAR)
+    __m256i vmask = _mm256_set1_epi8((char)mask), vwant = _mm256_set1_epi8((char)want);
+    for (; j + 32 <= p->size; j += 32) {
+        __m256i e = _mm256_loadu_si256((const __m256i*)(const void*)(p->edges + j));
+        uint32_t hit = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(e, vmask), vwant));
+        bits[j / 64] |= (uint64_t)hit << (j % 64);
+    }
+#elif defined(__SSE2__) && !defined(PILE_SCALAR)
+    __m128i vmask = _mm_set1_epi8((char)mask), vwant = _mm_set1_epi8((char)want);
+    for (; j + 16 <= p->size; j += 16) {
+        __m128i e = _mm_loadu_si128((const __m128i*)(const void*)(p->edges + j));
+        uint32_t hit = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(e, vmask), vwant));
+        bits[j / 64] |= (uint64_t)hit << (j % 64);
+    }
+#endif
+    for (; j < p->size; j++) {
+        if ((p->edges[j] & mask) == want) {
+            bits[j / 64] |= (uint64_t)1 << (j % 64);
+        }
+    }
+
+    return pile_countBits(bits, words);
+}
+
+size_t pile_countBits(const uint64_t* bits, size_t words) {
+    size_t count = 0;
+    for (size_t w = 0; w < words; w++) {
+        count += (size_t)popcount64(bits[w]);
+    }
+    return count;
+}
+
+size_t pile_nextBit(const uint64_t* bits, size_t words, size_t from) {
+    size_t w = from / 64;
+    if (w >= words) {
+        return words * 64;
+    }
+    uint64_t rest = bits[w] & (~(uint64_t)0 << (from % 64));
+    while (!rest) {
+        if (++w == words) {
+            return words * 64;
+        }
+        rest = bits[w];
+    }
+    // the lowest set bit alone, its index is the popcount of the bits below it
+    return w * 64 + (size_t)popcount64((rest & (0 - rest)) - 1);
+}
@@ -0,0 +1,375 @@
+#include "plan.h"
+#include "region.h"
+#include "tile_tables.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// free cells kept around the tiles on the tracker besides the window, it is rebuilt when a tile gets closer
+#define PLAN_MARGIN 16
+// cell of a step passing a tile over
+#define PLAN_SKIP UINT32_MAX
+// parent of the steps made from the committed position
+#define PLAN_ROOT SIZE_MAX
+
+static const int rowStep[4] = { -1, 0, 1, 0 };
+static const int columnStep[4] = { 0, 1, 0, -1 };
+
+// tile of the committed position in plan coordinates, to rebuild the tracker from
+typedef struct {
+    long row;
+    long column;
+    uint16_t code;
+} plan_tile;
+
+// position of a search: the step and the position it was made from
+typedef struct {
+    size_t parent;          // index in the kept states, PLAN_ROOT for the committed position
+    uint32_t cell;          // tracker cell, PLAN_SKIP if the tile was passed over
+    uint16_t code;          // tile_code as placed
+    uint8_t rotation;
+    int score;
+    uint64_t hash;          // of the cells and tiles placed since the committed position
+    size_t order;           // generation order, breaks ties between equal scores
+} plan_state;
+
+typedef struct {
+    size_t window;
+    size_t width;
+    region_tracker r;
+    long originRow;         // plan coordinates of tracker cell (0, 0)
+    long originColumn;
+    plan_tile* placed;
+    size_t placedCount;
+    // empty cells next to committed tiles
+    size_t* frontier;
+    size_t frontierCount;
+    bool* listed;
+    // cells a position can take its tile to
+    size_t* candidates;
+    size_t candidateCount;
+    uint32_t* stamp;
+    uint32_t generation;
+    // states kept by the beam and the children of the current depth
+    plan_state* states;
+    size_t stateCount;
+    size_t stateCapacity;
+    plan_state* children;
+    size_t childCount;
+    size_t childCapacity;
+    // merging of children reaching the same position
+    uint64_t* keys;
+    uint32_t* keyStamp;
+    size_t keyCapacity;
+    uint32_t depthStamp;
+    size_t* beam;
+    size_t* nextBeam;
+    size_t* chain;
+    size_t positions;
+    size_t merged;
+} planner;
+
+static uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// empty neighbour of a tracker cell in a direction, SIZE_MAX if it is taken or off the tracker
+static size_t emptyNeighbour(const planner* p, size_t cell, int d) {
+    size_t row = cell / p->r.columns, column = cell % p->r.columns;
+    if((rowStep[d] < 0 && row == 0) || (columnStep[d] < 0 && column == 0)
+            || (rowStep[d] > 0 && row + 1 >= p->r.rows) || (columnStep[d] > 0 && column + 1 >= p->r.columns)) {
+        return SIZE_MAX;
+    }
+    size_t next = (size_t)((long)row + rowStep[d]) * p->r.columns + (size_t)((long)column + columnStep[d]);
+    return p->r.cells[next] ? SIZE_MAX : next;
+}
+
+static void frontierAdd(planner* p, size_t cell) {
+    for(int d = 0; d < 4; d++) {
+        size_t next = emptyNeighbour(p, cell, d);
+        if(next != SIZE_MAX && !p->listed[next]) {
+            p->listed[next] = true;
+            p->frontier[p->frontierCount++] = next;
+        }
+    }
+}
+
+// places the committed tiles on a new tracker with room for the window around them
+static void planner_build(planner* p) {
+    long minRow = p->placed[0].row, maxRow = minRow, minColumn = p->placed[0].column, maxColumn = minColumn;
+    for(size_t k = 1; k < p->placedCount; k++) {
+        if(p->placed[k].row < minRow) minRow = p->placed[k].row;
+        if(p->placed[k].row > maxRow) maxRow = p->placed[k].row;
+        if(p->placed[k].column < minColumn) minColumn = p->placed[k].column;
+        if(p->placed[k].column > maxColumn) maxColumn = p->placed[k].column;
+    }
+    long margin = (long)(PLAN_MARGIN + p->window);
+    p->originRow = minRow - margin;
+    p->originColumn = minColumn - margin;
+    size_t rows = (size_t)(maxRow - minRow + 1 + 2 * margin), columns = (size_t)(maxColumn - minColumn + 1 + 2 * margin);
+
+    region_free(&p->r);
+    region_init(&p->r, rows, columns);
+    free(p->frontier);
+    free(p->listed);
+    free(p->candidates);
+    free(p->stamp);
+    p->frontier = malloc(rows * columns * sizeof(size_t));
+    p->listed = calloc(rows * columns, sizeof(bool));
+    p->candidates = malloc(rows * columns * sizeof(size_t));
+    p->stamp = calloc(rows * columns, sizeof(uint32_t));
+    p->generation = 0;
+    p->frontierCount = 0;
+    for(size_t k = 0; k < p->placedCount; k++) {
+        region_place(&p->r, (size_t)(p->placed[k].row - p->originRow), (size_t)(p->placed[k].column - p->originColumn),
+                     p->placed[k].code);
+    }
+    for(size_t k = 0; k < p->placedCount; k++) {
+        frontierAdd(p, (size_t)(p->placed[k].row - p->originRow) * columns + (size_t)(p->placed[k].column - p->originColumn));
+    }
+    region_enableUndo(&p->r);
+}
+
+// lines of the window must not leave the tracker
+static bool planner_nearBorder(const planner* p, size_t cell) {
+    size_t row = cell / p->r.columns, column = cell % p->r.columns, room = p->window + 1;
+    return row < room || column < room || row + room >= p->r.rows || column + room >= p->r.columns;
+}
+
+// puts the steps of a state on the tracker, oldest first, and lists the cells its next tile may go to
+static void planner_enter(planner* p, size_t state) {
+    size_t length = 0;
+    for(size_t s = state; s != PLAN_ROOT; s = p->states[s].parent) {
+        p->chain[length++] = s;
+    }
+    while(length > 0) {
+        const plan_state* step = &p->states[p->chain[--length]];
+        if(step->cell != PLAN_SKIP) {
+            region_place(&p->r, step->cell / p->r.columns, step->cell % p->r.columns, step->code);
+        }
+    }
+
+    if(++p->generation == 0) {
+        memset(p->stamp, 0, p->r.rows * p->r.columns * sizeof(uint32_t));
+        p->generation = 1;
+    }
+    p->candidateCount = 0;
+    for(size_t k = 0; k < p->frontierCount; k++) {
+        size_t cell = p->frontier[k];
+        if(!p->r.cells[cell]) {
+            p->stamp[cell] = p->generation;
+            p->candidates[p->candidateCount++] = cell;
+        }
+    }
+    for(size_t s = state; s != PLAN_ROOT; s = p->states[s].parent) {
+        if(p->states[s].cell == PLAN_SKIP) continue;
+        for(int d = 0; d < 4; d++) {
+            size_t next = emptyNeighbour(p, p->states[s].cell, d);
+            if(next != SIZE_MAX && p->stamp[next] != p->generation) {
+                p->stamp[next] = p->generation;
+                p->candidates[p->candidateCount++] = next;
+            }
+        }
+    }
+}
+
+static void planner_addChild(planner* p, plan_state child) {
+    if(p->childCount == p->childCapacity) {
+        p->childCapacity = p->childCapacity ? p->childCapacity * 2 : 256;
+        p->children = realloc(p->children, p->childCapacity * sizeof(plan_state));
+    }
+    child.order = p->childCount;
+    p->children[p->childCount++] = child;
+}
+
+// every placement of the tile from the state, a pass when it fits nowhere
+static void planner_expand(planner* p, size_t state, const tile* t) {
+    size_t mark = region_mark(&p->r);
+    planner_enter(p, state);
+    uint64_t hash = state == PLAN_ROOT ? 0 : p->states[state].hash;
+    int score = p->r.score;
+    size_t before = p->childCount;
+    size_t code = tile_code(t);
+    for(size_t rot = 0; rot < tile_infos[code].rotations; rot++) {
+        size_t placedCode = code;
+        for(size_t k = 0; k < rot; k++) placedCode = tile_infos[placedCode].rotated;
+        for(size_t c = 0; c < p->candidateCount; c++) {
+            size_t cell = p->candidates[c];
+            size_t row = cell / p->r.columns, column = cell % p->r.columns;
+            if(!region_fits(&p->r, row, column, placedCode)) continue;
+            size_t placeMark = region_mark(&p->r);
+            int after = region_place(&p->r, row, column, placedCode);
+            region_undo(&p->r, placeMark);
+            planner_addChild(p, (plan_state){ state, (uint32_t)cell, (uint16_t)placedCode, (uint8_t)rot, after,
+                                              hash ^ mix((uint64_t)cell * TILE_CODES + placedCode), 0 });
+        }
+    }
+    if(p->childCount == before) {
+        planner_addChild(p, (plan_state){ state, PLAN_SKIP, 0, 0, score, hash, 0 });
+    }
+    region_undo(&p->r, mark);
+}
+
+static int child_compare(const void* a, const void* b) {
+    const plan_state* x = a;
+    const plan_state* y = b;
+    if(x->score != y->score) return x->score > y->score ? -1 : 1;
+    return x->order < y->order ? -1 : x->order > y->order;
+}
+
+// true the first time a position is met at the current depth
+static bool planner_firstVisit(planner* p, uint64_t hash) {
+    size_t mask = p->keyCapacity - 1;
+    for(size_t i = (size_t)mix(hash) & mask;; i = (i + 1) & mask) {
+        if(p->keyStamp[i] != p->depthStamp) {
+            p->keyStamp[i] = p->depthStamp;
+            p->keys[i] = hash;
+            return true;
+        }
+        if(p->keys[i] == hash) {
+            return false;
+        }
+    }
+}
+
+// keeps the best children of the depth that reach different positions, returns how many
+static size_t planner_select(planner* p) {
+    qsort(p->children, p->childCount, sizeof(plan_state), child_compare);
+    if(p->keyCapacity < 2 * p->childCount) {
+        while(p->keyCapacity < 2 * p->childCount) {
+            p->keyCapacity = p->keyCapacity ? p->keyCapacity * 2 : 1024;
+        }
+        free(p->keys);
+        free(p->keyStamp);
+        p->keys = malloc(p->keyCapacity * sizeof(uint64_t));
+        p->keyStamp = calloc(p->keyCapacity, sizeof(uint32_t));
+        p->depthStamp = 0;
+    }
+    p->depthStamp++;
+
+    size_t kept = 0;
+    for(size_t k = 0; k < p->childCount; k++) {
+        if(!planner_firstVisit(p, p->children[k].hash)) {
+            p->merged++;
+            continue;
+        }
+        if(kept < p->width) {
+            if(p->stateCount == p->stateCapacity) {
+                p->stateCapacity = p->stateCapacity ? p->stateCapacity * 2 : 256;
+                p->states = realloc(p->states, p->stateCapacity * sizeof(plan_state));
+            }
+            p->nextBeam[kept++] = p->stateCount;
+            p->states[p->stateCount++] = p->children[k];
+        }
+    }
+    p->positions += p->childCount;
+    return kept;
+}
+
+// first step of the best line over the window starting at tile first
+static plan_state planner_search(planner* p, const sized_tlist* list, size_t first) {
+    size_t depth = list->size - first < p->window ? list->size - first : p->window;
+    p->stateCount = 0;
+    p->beam[0] = PLAN_ROOT;
+    size_t beamCount = 1;
+    for(size_t d = 0; d < depth; d++) {
+        p->childCount = 0;
+        for(size_t b = 0; b < beamCount; b++) {
+            planner_expand(p, p->beam[b], list->tiles[first + d]);
+        }
+        beamCount = planner_select(p);
+        size_t* swap = p->beam;
+        p->beam = p->nextBeam;
+        p->nextBeam = swap;
+    }
+    size_t s = p->beam[0];
+    while(p->states[s].parent != PLAN_ROOT) {
+        s = p->states[s].parent;
+    }
+    return p->states[s];
+}
+
+void plan_deal(const sized_board* board, const sized_tlist* list, const ai_config* config, plan_step* steps,
+               ai_stats* stats) {
+    planner p;
+    memset(&p, 0, sizeof(p));
+    p.window = config->planWindow ? config->planWindow : 1;
+    p.width = config->planBeam ? config->planBeam : 1;
+    p.placed = malloc((board->size * board->size + list->size + 1) * sizeof(plan_tile));
+    for(size_t i = 0; i < board->size; i++) {
+        for(size_t j = 0; j < board->size; j++) {
+            if(board->tiles[i][j]) {
+                p.placed[p.placedCount++] = (plan_tile){ (long)i, (long)j, (uint16_t)tile_code(board->tiles[i][j]) };
+            }
+        }
+    }
+    p.beam = malloc(p.width * sizeof(size_t));
+    p.nextBeam = malloc(p.width * sizeof(size_t));
+    p.chain = malloc(p.window * sizeof(size_t));
+
+    size_t first = 0;
+    if(p.placedCount == 0 && list->size > 0) {
+        // the first tile of an empty board goes to its centre as it is
+        long centre = (long)(board->size / 2);
+        p.placed[p.placedCount++] = (plan_tile){ centre, centre, (uint16_t)tile_code(list->tiles[0]) };
+        steps[0] = (plan_step){ 0, true, centre, centre, 0, 0 };
+        first = 1;
+    }
+    if(p.placedCount > 0) {
+        planner_build(&p);
+        if(first == 1) {
+            steps[0].score = p.r.score;
+        }
+    }
+
+    for(size_t i = first; i < list->size; i++) {
+        plan_state step = planner_search(&p, list, i);
+        if(step.cell == PLAN_SKIP) {
+            steps[i] = (plan_step){ i, false, 0, 0, 0, p.r.score };
+            continue;
+        }
+        size_t row = step.cell / p.r.columns, column = step.cell % p.r.columns;
+        region_place(&p.r, row, column, step.code);
+        region_commit(&p.r);
+        plan_tile placed = { (long)row + p.originRow, (long)column + p.originColumn, step.code };
+        p.placed[p.placedCount++] = placed;
+        steps[i] = (plan_step){ i, true, placed.row, placed.column, (rotation_t)step.rotation, p.r.score };
+
+        // the cell leaves the frontier, its empty neighbours join it
+        size_t kept = 0;
+        for(size_t k = 0; k < p.frontierCount; k++) {
+            if(p.frontier[k] == step.cell) {
+                p.listed[step.cell] = false;
+            } else {
+                p.frontier[kept++] = p.frontier[k];
+            }
+        }
+        p.frontierCount = kept;
+        frontierAdd(&p, step.cell);
+        if(planner_nearBorder(&p, step.cell)) {
+            planner_build(&p);
+        }
+    }
+
+    if(stats) {
+        stats->planPositions += p.positions;
+        stats->planMerged += p.merged;
+    }
+    region_free(&p.r);
+    free(p.placed);
+    free(p.frontier);
+    free(p.listed);
+    free(p.candidates);
+    free(p.stamp);
+    free(p.states);
+    free(p.children);
+    free(p.keys);
+    free(p.keyStamp);
+    free(p.beam);
+    free(p.nextBeam);
+    free(p.chain);
+}
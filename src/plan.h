@@ -0,0 +1,36 @@
+#ifndef PLAN_H
+#define PLAN_H
+/** @file plan.h */
+
+#include "ai.h"
+
+/**
+* placement of one tile of a known deal
+*/
+typedef struct {
+    size_t tileIndex;       ///< position of the tile in the deal
+    bool placed;            ///< false if the tile fit nowhere and was passed over
+    long row;               ///< row relative to the board the plan starts from
+    long column;            ///< column relative to the board the plan starts from
+    rotation_t rotation;    ///< rotation of the tile as it is in the list
+    int score;              ///< score of the board after the step
+} plan_step;
+
+/**
+* Plans a deal played in list order: the tiles come one after the other and each has to be placed
+* when it is drawn, a tile that fits nowhere is passed over.
+* Every tile is chosen by a beam search over the next config->planWindow tiles that keeps the
+* config->planBeam best positions of every depth. Positions are kept as a step and the position
+* it was made from, so lines share their beginnings, and lines reaching the same tiles on the same
+* cells are merged. The first step of the best line is made and the window moves on by one tile.
+* Scores are kept up to date by a region tracker, the board is not copied
+* @param [in] board board the deal starts on
+* @param [in] list deal, in the order the tiles are drawn
+* @param [in] search settings
+* @param [out] steps one step per tile of the list
+* @param [out] generated and merged positions are added, may be NULL
+*/
+void plan_deal(const sized_board* board, const sized_tlist* list, const ai_config* config, plan_step* steps,
+               ai_stats* stats);
+
+#endif
@@ -0,0 +1,557 @@
+#include "region.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const int rowStep[4] = { -1, 0, 1, 0 };
+static const int columnStep[4] = { 0, 1, 0, -1 };
+
+// arrays a logged change can belong to, count, score and the bound counters are logged as single values
+enum { LOG_CELLS, LOG_PARENT, LOG_NEXT, LOG_OPEN, LOG_POINTS, LOG_UNITS, LOG_COUNT, LOG_SCORE, LOG_OPEN_UNITS,
+       LOG_TEMPLE_SLOTS };
+
+void region_init(region_tracker* r, size_t rows, size_t columns) {
+    memset(r, 0, sizeof(*r));
+    r->rows = rows;
+    r->columns = columns;
+    r->bottom = rows;
+    r->right = columns;
+    r->cells = calloc(rows * columns + 1, sizeof(uint32_t));
+}
+
+void region_free(region_tracker* r) {
+    free(r->cells);
+    free(r->codes);
+    free(r->at);
+    free(r->parent);
+    free(r->next);
+    free(r->open);
+    free(r->points);
+    free(r->units);
+    free(r->status);
+    free(r->visited);
+    free(r->marked);
+    free(r->stack);
+    free(r->order);
+    free(r->borderTiles);
+    free(r->log);
+    memset(r, 0, sizeof(*r));
+}
+
+static void region_grow(region_tracker* r) {
+    size_t old = r->capacity;
+    r->capacity = r->capacity ? r->capacity * 2 : 64;
+    r->codes = realloc(r->codes, r->capacity * sizeof(uint16_t));
+    r->at = realloc(r->at, r->capacity * sizeof(uint32_t));
+    r->parent = realloc(r->parent, r->capacity * 4 * sizeof(uint32_t));
+    r->next = realloc(r->next, r->capacity * 4 * sizeof(uint32_t));
+    r->open = realloc(r->open, r->capacity * 4 * sizeof(uint32_t));
+    r->points = realloc(r->points, r->capacity * 4 * sizeof(uint32_t));
+    r->units = realloc(r->units, r->capacity * 4 * sizeof(uint32_t));
+    r->status = realloc(r->status, r->capacity * 4);
+    r->visited = realloc(r->visited, r->capacity * 4 * sizeof(uint32_t));
+    r->marked = realloc(r->marked, r->capacity * 4 * sizeof(uint32_t));
+    // the walk numbers of the new sides must not match a current one
+    memset(r->visited + old * 4, 0, (r->capacity - old) * 4 * sizeof(uint32_t));
+    memset(r->marked + old * 4, 0, (r->capacity - old) * 4 * sizeof(uint32_t));
+}
+
+static void region_log(region_tracker* r, uint8_t array, uint32_t index, uint32_t value) {
+    if (r->logSize == r->logCapacity) {
+        r->logCapacity = r->logCapacity ? r->logCapacity * 2 : 64;
+        r->log = realloc(r->log, r->logCapacity * sizeof(region_change));
+    }
+    r->log[r->logSize++] = (region_change){ array, index, value };
+}
+
+// writes a value of one of the side arrays, the old value is logged when undo is enabled
+static void region_set(region_tracker* r, uint8_t array, uint32_t* values, uint32_t index, uint32_t value) {
+    if (r->undoable) {
+        region_log(r, array, index, values[index]);
+    }
+    values[index] = value;
+}
+
+static uint32_t region_find(region_tracker* r, uint32_t s) {
+    while (r->parent[s] != s) {
+        region_set(r, LOG_PARENT, r->parent, s, r->parent[r->parent[s]]);
+        s = r->parent[s];
+    }
+    return s;
+}
+
+// joins the regions of two sides, matched sides face each other and are no longer open
+static void region_join(region_tracker* r, uint32_t a, uint32_t b, bool matched) {
+    a = region_find(r, a);
+    b = region_find(r, b);
+    if (a != b) {
+        // the rings of both regions become one
+        uint32_t after = r->next[a];
+        region_set(r, LOG_NEXT, r->next, a, r->next[b]);
+        region_set(r, LOG_NEXT, r->next, b, after);
+        region_set(r, LOG_PARENT, r->parent, b, a);
+        region_set(r, LOG_OPEN, r->open, a, r->open[a] + r->open[b]);
+    }
+    if (matched) {
+        region_set(r, LOG_OPEN, r->open, a, r->open[a] - 2);
+    }
+}
+
+// tile index + 1 of the neighbour in a direction, 0 if there is none
+static uint32_t neighbour(const region_tracker* r, size_t row, size_t column, int dr, int dc) {
+    if ((dr < 0 && row == 0) || (dc < 0 && column == 0)
+            || (dr > 0 && row + 1 >= r->rows) || (dc > 0 && column + 1 >= r->columns)) {
+        return 0;
+    }
+    return r->cells[(size_t)((ptrdiff_t)row + dr) * r->columns + (size_t)((ptrdiff_t)column + dc)];
+}
+
+static element edge(uint8_t edges, int d) {
+    return (element)((edges >> (2 * d)) & 3u);
+}
+
+bool region_fits(const region_tracker* r, size_t row, size_t column, size_t code) {
+    if (row >= r->rows || column >= r->columns || r->cells[row * r->columns + column]) {
+        return false;
+    }
+    uint8_t edges = tile_infos[code].edges;
+    size_t count = 0;
+    for (int d = NORTH; d <= WEST; d++) {
+        uint32_t n = neighbour(r, row, column, rowStep[d], columnStep[d]);
+        if (n) {
+            count++;
+            if (edge(tile_infos[r->codes[n - 1]].edges, (d + 2) % 4) != edge(edges, d)) {
+                return false;
+            }
+        }
+    }
+    return count > 0 || r->count == 0;
+}
+
+// the walks below follow castleCompleted, tile_castleCompleted, roadCompleted, tile_roadCompleted
+// and roadScoreForTwo of calculator.c step by step, on the sides of the tracker instead of the board
+
+// if a side of a tile faces the border of the frame
+static bool walk_atBorder(const region_tracker* r, uint32_t t, int d) {
+    size_t row = r->at[t] / r->columns, column = r->at[t] % r->columns;
+    switch (d) {
+    case NORTH: return row <= r->top;
+    case EAST:  return column + 1 >= r->right;
+    case SOUTH: return row + 1 >= r->bottom;
+    default:    return column <= r->left;
+    }
+}
+
+// tile index + 1 of the neighbour of a tile in a direction, the side must not face the border
+static uint32_t walk_neighbour(const region_tracker* r, uint32_t t, int d) {
+    return r->cells[(size_t)((ptrdiff_t)r->at[t] + rowStep[d] * (ptrdiff_t)r->columns + columnStep[d])];
+}
+
+static void walk_begin(region_tracker* r) {
+    if (++r->walk == 0) {
+        memset(r->visited, 0, r->count * 4 * sizeof(uint32_t));
+        r->walk = 1;
+    }
+    r->stackSize = 0;
+}
+
+static void walk_push(region_tracker* r, uint32_t s) {
+    if (r->stackSize == r->stackCapacity) {
+        r->stackCapacity = r->stackCapacity ? r->stackCapacity * 2 : 64;
+        r->stack = realloc(r->stack, r->stackCapacity * sizeof(uint32_t));
+    }
+    r->stack[r->stackSize++] = s;
+    r->visited[s] = r->walk;
+}
+
+// if the side of a tile, tile index + 1, was visited by the current walk
+static bool walk_hasSide(const region_tracker* r, uint32_t n, int d) {
+    return n && r->visited[(n - 1) * 4 + (uint32_t)d] == r->walk;
+}
+
+// every side the walk visited gets its result
+static void walk_finish(region_tracker* r, bool completed) {
+    for (size_t k = 0; k < r->stackSize; k++) {
+        r->status[r->stack[k]] = completed ? 1 : -1;
+    }
+    r->stackSize = 0;
+}
+
+// tile_castleCompleted: the walk entered tile n, index + 1, going in direction dir
+static bool walk_castleTile(region_tracker* r, uint32_t n, int dir) {
+    if (!n) {
+        return false;
+    }
+    uint32_t t = n - 1;
+    int entry = (dir + 2) % 4;
+    if (r->status[t * 4 + (uint32_t)entry]) {
+        return r->status[t * 4 + (uint32_t)entry] > 0;
+    }
+    walk_push(r, t * 4 + (uint32_t)entry);
+
+    const tile_info* info = &tile_infos[r->codes[t]];
+    if (info->castleGroupSize == 1) {
+        return true;
+    }
+    bool isCompl = true;
+    for (size_t k = 0; k < info->segments[CASTLE] && isCompl; k++) {
+        int d = info->sides[CASTLE][k];
+        bool compl = true;
+        if (walk_atBorder(r, t, d)) {
+            compl = false;
+        } else {
+            uint32_t m = walk_neighbour(r, t, d);
+            if (!walk_hasSide(r, m, (d + 2) % 4) && d != entry) {
+                walk_push(r, t * 4 + (uint32_t)d);
+                compl = walk_castleTile(r, m, d);
+            }
+        }
+        isCompl &= compl;
+    }
+    return isCompl;
+}
+
+// castleCompleted
+static bool walk_castle(region_tracker* r, uint32_t t, int dir) {
+    uint32_t own = t * 4 + (uint32_t)dir;
+    if (r->status[own]) {
+        return r->status[own] > 0;
+    }
+    if (walk_atBorder(r, t, dir)) {
+        r->status[own] = -1;
+        return false;
+    }
+    walk_begin(r);
+    walk_push(r, own);
+    bool isCompl = walk_castleTile(r, walk_neighbour(r, t, dir), dir);
+    walk_finish(r, isCompl);
+    return isCompl;
+}
+
+// tile_roadCompleted: the walk entered tile n, index + 1, going in direction dir
+static bool walk_roadTile(region_tracker* r, uint32_t n, int dir) {
+    while (n) {
+        uint32_t t = n - 1;
+        int entry = (dir + 2) % 4;
+        if (r->status[t * 4 + (uint32_t)entry]) {
+            return r->status[t * 4 + (uint32_t)entry] > 0;
+        }
+        // road came back to a side visited in this walk: it is a closed loop
+        if (walk_hasSide(r, n, entry)) {
+            return true;
+        }
+        walk_push(r, t * 4 + (uint32_t)entry);
+
+        const tile_info* info = &tile_infos[r->codes[t]];
+        if (info->roadEnds) {
+            return true;
+        }
+        // the first road side going on, north to west
+        int exit = -1;
+        for (int d = NORTH; d <= WEST && exit < 0; d++) {
+            if (edge(info->edges, d) == ROAD && d != entry && !walk_atBorder(r, t, d)) {
+                exit = d;
+            }
+        }
+        if (exit < 0) {
+            return false;
+        }
+        walk_push(r, t * 4 + (uint32_t)exit);
+        n = walk_neighbour(r, t, exit);
+        dir = exit;
+    }
+    return false;
+}
+
+// roadCompleted
+static bool walk_road(region_tracker* r, uint32_t t, int dir) {
+    uint32_t own = t * 4 + (uint32_t)dir;
+    if (r->status[own]) {
+        return r->status[own] > 0;
+    }
+    if (walk_atBorder(r, t, dir)) {
+        r->status[own] = -1;
+        return false;
+    }
+    walk_begin(r);
+    walk_push(r, own);
+    bool isCompl = walk_roadTile(r, walk_neighbour(r, t, dir), dir);
+    walk_finish(r, isCompl);
+    return isCompl;
+}
+
+// roadScoreForTwo: points of the road of a tile with two road sides
+static int walk_roadForTwo(region_tracker* r, uint32_t t, const uint8_t* sides) {
+    switch (r->status[t * 4 + sides[0]] * r->status[t * 4 + sides[1]]) {
+    case 1:
+        return 2;
+    case -1:
+        return 1;
+    }
+    walk_begin(r);
+    bool isCompl = true;
+    for (size_t k = 0; k < 2; k++) {
+        walk_push(r, t * 4 + sides[k]);
+        if (walk_atBorder(r, t, sides[k])) {
+            isCompl = false;
+            continue;
+        }
+        bool compl = walk_roadTile(r, walk_neighbour(r, t, sides[k]), sides[k]);
+        isCompl = isCompl && compl;
+    }
+    walk_finish(r, isCompl);
+    return isCompl ? 2 : 1;
+}
+
+static int order_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// scores the castles and roads of a region like score() does: its tiles in board order,
+// the completion of a side is the one of the first walk reaching it
+static void region_score(region_tracker* r, uint32_t root, uint32_t* points, uint32_t* units) {
+    if (++r->scoring == 0) {
+        memset(r->marked, 0, r->count * 4 * sizeof(uint32_t));
+        r->scoring = 1;
+    }
+    size_t count = 0;
+    uint32_t s = root;
+    do {
+        if (count == r->orderCapacity) {
+            r->orderCapacity = r->orderCapacity ? r->orderCapacity * 2 : 64;
+            r->order = realloc(r->order, r->orderCapacity * sizeof(uint64_t));
+        }
+        r->order[count++] = (uint64_t)r->at[s / 4] << 32 | s / 4;
+        r->marked[s] = r->scoring;
+        r->status[s] = 0;
+        s = r->next[s];
+    } while (s != root);
+    qsort(r->order, count, sizeof(uint64_t), order_compare);
+
+    *points = 0;
+    *units = 0;
+    for (size_t k = 0; k < count; k++) {
+        if (k > 0 && r->order[k] == r->order[k - 1]) {
+            continue;
+        }
+        uint32_t t = (uint32_t)r->order[k];
+        const tile_info* info = &tile_infos[r->codes[t]];
+        const uint8_t* castles = info->sides[CASTLE];
+        for (size_t g = 0; g < info->castleGroups; g++) {
+            const uint8_t* group = castles + g * info->castleGroupSize;
+            if (r->marked[t * 4 + group[0]] != r->scoring) continue;
+            bool completed = true;
+            for (size_t c = 0; c < info->castleGroupSize && completed; c++) {
+                completed = walk_castle(r, t, group[c]);
+            }
+            *points += 1 + completed;
+            *units += !completed;
+        }
+        const uint8_t* roads = info->sides[ROAD];
+        if (info->segments[ROAD] == 2) {
+            if (r->marked[t * 4 + roads[0]] == r->scoring) {
+                int two = walk_roadForTwo(r, t, roads);
+                *points += (uint32_t)two;
+                *units += two == 1;
+            }
+        } else {
+            for (size_t c = 0; c < info->segments[ROAD]; c++) {
+                if (r->marked[t * 4 + roads[c]] != r->scoring) continue;
+                bool completed = walk_road(r, t, roads[c]);
+                *points += 1 + completed;
+                *units += !completed;
+            }
+        }
+    }
+}
+
+// takes the points of a region out of the score, before it is joined or scored again
+static void region_drop(region_tracker* r, uint32_t root) {
+    r->score -= (int)r->points[root];
+    if (r->open[root]) {
+        r->openUnits -= (int)r->units[root];
+    }
+}
+
+// scores a region again and adds its points to the score
+static void region_rescore(region_tracker* r, uint32_t root) {
+    uint32_t points, units;
+    region_score(r, root, &points, &units);
+    region_set(r, LOG_POINTS, r->points, root, points);
+    region_set(r, LOG_UNITS, r->units, root, units);
+    r->score += (int)points;
+    if (r->open[root]) {
+        r->openUnits += (int)units;
+    }
+}
+
+// the distinct regions of the castle and road sides of a tile
+static size_t tile_regions(region_tracker* r, uint32_t t, uint32_t roots[static 4]) {
+    uint8_t edges = tile_infos[r->codes[t]].edges;
+    size_t count = 0;
+    for (uint32_t d = 0; d < 4; d++) {
+        if (edge(edges, (int)d) == FIELD) continue;
+        uint32_t root = region_find(r, t * 4 + d);
+        bool seen = false;
+        for (size_t k = 0; k < count; k++) {
+            seen |= roots[k] == root;
+        }
+        if (!seen) {
+            roots[count++] = root;
+        }
+    }
+    return count;
+}
+
+static bool tile_onBorder(const region_tracker* r, uint32_t t) {
+    return walk_atBorder(r, t, NORTH) || walk_atBorder(r, t, EAST)
+        || walk_atBorder(r, t, SOUTH) || walk_atBorder(r, t, WEST);
+}
+
+int region_place(region_tracker* r, size_t row, size_t column, size_t code) {
+    const tile_info* info = &tile_infos[code];
+    if (r->count == r->capacity) {
+        region_grow(r);
+    }
+    if (r->undoable) {
+        // the sides of the new tile lie past the count, restoring it drops them
+        region_log(r, LOG_COUNT, 0, (uint32_t)r->count);
+        region_log(r, LOG_SCORE, 0, (uint32_t)r->score);
+        region_log(r, LOG_OPEN_UNITS, 0, (uint32_t)r->openUnits);
+        region_log(r, LOG_TEMPLE_SLOTS, 0, (uint32_t)r->templeSlots);
+        region_log(r, LOG_CELLS, (uint32_t)(row * r->columns + column), 0);
+    }
+    uint32_t t = (uint32_t)r->count++, base = t * 4;
+    r->cells[row * r->columns + column] = t + 1;
+    r->codes[t] = (uint16_t)code;
+    r->at[t] = (uint32_t)(row * r->columns + column);
+
+    for (uint32_t d = 0; d < 4; d++) {
+        r->parent[base + d] = base + d;
+        r->next[base + d] = base + d;
+        r->open[base + d] = edge(info->edges, (int)d) != FIELD;
+        r->points[base + d] = 0;
+        r->units[base + d] = 0;
+        r->status[base + d] = 0;
+    }
+
+    // the regions the tile joins are scored again once it is in them
+    for (int d = NORTH; d <= WEST; d++) {
+        uint32_t n = neighbour(r, row, column, rowStep[d], columnStep[d]);
+        if (n && edge(info->edges, d) != FIELD) {
+            uint32_t root = region_find(r, (n - 1) * 4 + (uint32_t)((d + 2) % 4));
+            bool seen = false;
+            for (int e = NORTH; e < d; e++) {
+                uint32_t m = neighbour(r, row, column, rowStep[e], columnStep[e]);
+                seen |= m && edge(info->edges, e) != FIELD && region_find(r, (m - 1) * 4 + (uint32_t)((e + 2) % 4)) == root;
+            }
+            if (!seen) {
+                region_drop(r, root);
+            }
+        }
+    }
+
+    // a castle group is one region, so is a tile with two roads as its road score walks both
+    const uint8_t* castles = info->sides[CASTLE];
+    for (size_t g = 0; g < info->castleGroups; g++) {
+        for (size_t k = 1; k < info->castleGroupSize; k++) {
+            region_join(r, base + castles[g * info->castleGroupSize], base + castles[g * info->castleGroupSize + k], false);
+        }
+    }
+    if (info->segments[ROAD] == 2) {
+        region_join(r, base + info->sides[ROAD][0], base + info->sides[ROAD][1], false);
+    }
+
+    // temples count the occupied cells around them
+    int gained = info->castleBonus;
+    int neighbours = 0;
+    for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            uint32_t n = (dr || dc) ? neighbour(r, row, column, dr, dc) : 0;
+            if (n) {
+                neighbours++;
+                gained += tile_infos[r->codes[n - 1]].temple;
+                gained += info->temple;
+                r->templeSlots -= tile_infos[r->codes[n - 1]].temple;
+            }
+        }
+    }
+    gained += info->temple;
+    r->templeSlots += info->temple * (8 - neighbours);
+    r->score += gained;
+
+    // join castles and roads with the facing sides of the neighbours
+    for (int d = NORTH; d <= WEST; d++) {
+        uint32_t n = neighbour(r, row, column, rowStep[d], columnStep[d]);
+        if (n && edge(info->edges, d) != FIELD) {
+            region_join(r, base + (uint32_t)d, (n - 1) * 4 + (uint32_t)((d + 2) % 4), true);
+        }
+    }
+
+    uint32_t roots[4];
+    size_t count = tile_regions(r, t, roots);
+    for (size_t k = 0; k < count; k++) {
+        region_rescore(r, roots[k]);
+    }
+
+    if (tile_onBorder(r, t)) {
+        if (r->borderCount == r->borderCapacity) {
+            r->borderCapacity = r->borderCapacity ? r->borderCapacity * 2 : 16;
+            r->borderTiles = realloc(r->borderTiles, r->borderCapacity * sizeof(uint32_t));
+        }
+        r->borderTiles[r->borderCount++] = t;
+    }
+    return r->score;
+}
+
+void region_setFrame(region_tracker* r, size_t top, size_t left, size_t bottom, size_t right) {
+    r->top = top;
+    r->left = left;
+    r->bottom = bottom;
+    r->right = right;
+    size_t kept = 0;
+    for (size_t k = 0; k < r->borderCount; k++) {
+        uint32_t t = r->borderTiles[k], roots[4];
+        if (t >= r->count) continue;
+        size_t count = tile_regions(r, t, roots);
+        for (size_t c = 0; c < count; c++) {
+            region_drop(r, roots[c]);
+            region_rescore(r, roots[c]);
+        }
+        if (tile_onBorder(r, t)) {
+            r->borderTiles[kept++] = t;
+        }
+    }
+    r->borderCount = kept;
+}
+
+void region_enableUndo(region_tracker* r) {
+    r->undoable = true;
+}
+
+size_t region_mark(const region_tracker* r) {
+    return r->logSize;
+}
+
+void region_undo(region_tracker* r, size_t mark) {
+    while (r->logSize > mark) {
+        const region_change* c = &r->log[--r->logSize];
+        switch (c->array) {
+        case LOG_CELLS:  r->cells[c->index] = c->value; break;
+        case LOG_PARENT: r->parent[c->index] = c->value; break;
+        case LOG_NEXT:   r->next[c->index] = c->value; break;
+        case LOG_OPEN:   r->open[c->index] = c->value; break;
+        case LOG_POINTS: r->points[c->index] = c->value; break;
+        case LOG_UNITS:  r->units[c->index] = c->value; break;
+        case LOG_COUNT:  r->count = c->value; break;
+        case LOG_SCORE:  r->score = (int)c->value; break;
+        case LOG_OPEN_UNITS:   r->openUnits = (int)c->value; break;
+        case LOG_TEMPLE_SLOTS: r->templeSlots = (int)c->value; break;
+        }
+    }
+}
+
+void region_commit(region_tracker* r) {
+    r->logSize = 0;
+}
@@ -0,0 +1,142 @@
+#ifndef REGION_H
+#define REGION_H
+/** @file region.h */
+
+#include "tile_tables.h"
+
+#include <stdint.h>
+
+/** @addtogroup Region
+* incremental scoring: castle and road sides of the placed tiles are joined into regions
+* with union-find, a region being every side a walk of score() can reach from one of them.
+* a road is followed through every tile with two roads, as the road score of such a tile
+* walks both of them. placing a tile scores the regions it joins again with the walks of
+* score(): their tiles in board order, every side keeping the completion of the first walk
+* that reached it. the regions elsewhere keep their points, so the score equals the one of
+* score() on the same tiles without walking the whole board.
+* the units scoring 1 point of the regions still open and the empty cells around temples
+* are counted along, they bound what later tiles can add to the score
+* once undo is enabled every change is logged, so placements can be taken back like on a frontier
+* @{
+*/
+typedef struct {
+    uint8_t array;      // which array the value was written to
+    uint32_t index;
+    uint32_t value;     // value before the change
+} region_change;
+
+typedef struct {
+    size_t rows;
+    size_t columns;
+    size_t top, left, bottom, right;    // frame of the board, walks end at its border, see region_setFrame
+    uint32_t* cells;    // index + 1 of the tile on every cell, 0 if empty
+    uint16_t* codes;    // tile_code of every placed tile
+    uint32_t* at;       // cell of every placed tile
+    uint32_t* parent;   // sides of the placed tiles, tile * 4 + direction
+    uint32_t* next;     // sides of a region in a ring
+    uint32_t* open;     // of a region root: sides without a neighbour
+    uint32_t* points;   // of a region root: points of its castles and roads
+    uint32_t* units;    // of a region root: units scoring 1 point, each can score 1 more
+    int8_t* status;     // walks: completion of every side, 0 unknown
+    uint32_t* visited;  // walks: number of the walk that last visited a side
+    uint32_t* marked;   // walks: number of the scoring that last marked a side as part of its region
+    uint32_t walk;
+    uint32_t scoring;
+    uint32_t* stack;    // walks: sides visited by the current walk
+    size_t stackSize;
+    size_t stackCapacity;
+    uint64_t* order;    // walks: cell << 32 | tile of the region scored, sorted into board order
+    size_t orderCapacity;
+    uint32_t* borderTiles; // tiles on the border of the frame
+    size_t borderCount;
+    size_t borderCapacity;
+    size_t count;
+    size_t capacity;
+    int score;
+    int openUnits;      // units of the regions with an open side scoring 1 point, each can score 1 more
+    int templeSlots;    // empty cells around the placed temples, each is 1 point once filled
+    bool undoable;
+    region_change* log;
+    size_t logSize;
+    size_t logCapacity;
+} region_tracker;
+/** @} */
+
+/**
+* initialize an empty tracker for a rectangle of cells.
+* @param [out] r tracker
+* @param [in] rows amount of rows
+* @param [in] columns amount of columns
+*/
+void region_init(region_tracker* r, size_t rows, size_t columns);
+
+/**
+* free the memory of the tracker.
+* @param [in,out] r tracker
+*/
+void region_free(region_tracker* r);
+
+/**
+* check if a tile can be placed: the cell is empty and all neighbours have matching edges.
+* on a non empty tracker at least one neighbour is needed
+* @param [in] r tracker
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @param [in] code tile_code of the tile as placed
+* @return if the tile fits
+*/
+bool region_fits(const region_tracker* r, size_t row, size_t column, size_t code);
+
+/**
+* place a tile and update the score.
+* the cell has to be empty, edges are not checked
+* @param [in,out] r tracker
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @param [in] code tile_code of the tile as placed
+* @return score after the placement
+*/
+int region_place(region_tracker* r, size_t row, size_t column, size_t code);
+
+/**
+* set the frame of the board the score is taken on: a walk of score() reaching its border finds
+* the side open without looking further, which can leave a road tile with 1 point where an empty
+* cell next to it gives 2. the regions of the tiles on the border of the old frame are scored again.
+* the frame starts as the whole tracker, tiles placed so far must not lie on the border of the new one.
+* it is not taken back by region_undo
+* @param [in,out] r tracker
+* @param [in] top first row of the frame
+* @param [in] left first column of the frame
+* @param [in] bottom row past the frame, at most the rows of the tracker
+* @param [in] right column past the frame, at most the columns of the tracker
+*/
+void region_setFrame(region_tracker* r, size_t top, size_t left, size_t bottom, size_t right);
+
+/**
+* log the changes of the following placements so they can be taken back.
+* a tracker replaying a whole game leaves it off and keeps no log
+* @param [in,out] r tracker
+*/
+void region_enableUndo(region_tracker* r);
+
+/**
+* current position in the change log, to return to with region_undo.
+* @param [in] r tracker with undo enabled
+* @return mark
+*/
+size_t region_mark(const region_tracker* r);
+
+/**
+* take back every placement made since the mark, score included.
+* @param [in,out] r tracker with undo enabled
+* @param [in] mark value of region_mark before the placements
+*/
+void region_undo(region_tracker* r, size_t mark);
+
+/**
+* forget the change log, the placements made so far stay for good.
+* @param [in,out] r tracker with undo enabled
+*/
+void region_commit(region_tracker* r);
+
+#endif
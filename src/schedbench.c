@@ -0,0 +1,123 @@
+#include "scheduler.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// items of the parallel loop and work per item
+#define LOOP_ITEMS  (1u << 18)
+#define ITEM_ROUNDS 100
+#define LOOP_GRAIN  64
+// depth of the spawn tree, below CUTOFF a task counts sequentially
+#define TREE_DEPTH  32
+#define TREE_CUTOFF 16
+
+typedef struct {
+    scheduler* s;
+    uint64_t* sums;     // one per worker, so the loop needs no atomics
+} loop_job;
+
+typedef struct {
+    scheduler* s;
+    unsigned n;
+    uint64_t result;
+} tree_job;
+
+static double now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e3 + (double)now.tv_nsec / 1e6;
+}
+
+static uint64_t item_value(uint64_t x) {
+    x = x * 0x9E3779B97F4A7C15ULL + 1;
+    for (unsigned r = 0; r < ITEM_ROUNDS; r++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+static void loop_body(void* arg, size_t begin, size_t end, size_t worker) {
+    loop_job* job = arg;
+    uint64_t sum = 0;
+    for (size_t i = begin; i < end; i++) {
+        sum += item_value(i);
+    }
+    job->sums[worker] += sum;
+}
+
+static uint64_t fib(unsigned n) {
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+// spawns one half and runs the other, the waiting task keeps its worker busy with stolen work
+static void tree_task(void* arg, size_t worker) {
+    tree_job* job = arg;
+    if (job->n < TREE_CUTOFF) {
+        job->result = fib(job->n);
+        return;
+    }
+    tree_job left = { job->s, job->n - 1, 0 }, right = { job->s, job->n - 2, 0 };
+    scheduler_group g = SCHEDULER_GROUP_INIT;
+    scheduler_spawn(job->s, &g, tree_task, &left);
+    tree_task(&right, worker);
+    scheduler_wait(job->s, &g);
+    job->result = left.result + right.result;
+}
+
+int main(int argc, char* argv[]) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t most = argc > 1 ? strtoul(argv[1], NULL, 10) : (cpus > 0 ? (size_t)cpus : 1);
+    if (most == 0) {
+        fputs("usage: schedbench [max-threads]\n", stderr);
+        return 1;
+    }
+
+    uint64_t loopExpected = 0;
+    for (size_t i = 0; i < LOOP_ITEMS; i++) {
+        loopExpected += item_value(i);
+    }
+    uint64_t treeExpected = fib(TREE_DEPTH);
+
+    double loopBase = 0, treeBase = 0;
+    bool ok = true;
+    printf("threads    loop ms  speedup    tree ms  speedup\n");
+    for (size_t threads = 1; threads <= most; threads++) {
+        scheduler* s = scheduler_create(threads);
+
+        loop_job loop = { s, calloc(threads, sizeof(uint64_t)) };
+        double start = now_ms();
+        scheduler_for(s, LOOP_ITEMS, LOOP_GRAIN, loop_body, &loop);
+        double loopMs = now_ms() - start;
+        uint64_t sum = 0;
+        for (size_t w = 0; w < threads; w++) {
+            sum += loop.sums[w];
+        }
+        free(loop.sums);
+
+        tree_job tree = { s, TREE_DEPTH, 0 };
+        scheduler_group g = SCHEDULER_GROUP_INIT;
+        start = now_ms();
+        scheduler_spawn(s, &g, tree_task, &tree);
+        scheduler_wait(s, &g);
+        double treeMs = now_ms() - start;
+        scheduler_destroy(s);
+
+        if (threads == 1) {
+            loopBase = loopMs;
+            treeBase = treeMs;
+        }
+        printf("%7zu %10.1f %8.2f %10.1f %8.2f\n", threads, loopMs, loopBase / loopMs, treeMs, treeBase / treeMs);
+        if (sum != loopExpected || tree.result != treeExpected) {
+            fprintf(stderr, "wrong result with %zu threads\n", threads);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,417 @@
+#include "scheduler.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// first capacity of a deque, it doubles when full
+#define DEQUE_CAPACITY 256
+// rounds of looking for work before an idle worker parks
+#define IDLE_SPINS 64
+// finished tasks a worker keeps for reuse
+#define FREE_TASKS 1024
+#define CACHE_LINE 64
+
+typedef struct task {
+    void (*run)(struct task* t, size_t worker);
+    scheduler_fn fn;
+    void* arg;
+    scheduler_group* group;
+    size_t begin, end;      // part of a parallel loop
+    struct task* next;      // free list, queue of the threads outside the pool
+} task;
+
+typedef struct deque_array {
+    int64_t capacity;               // power of 2
+    struct deque_array* retired;    // arrays replaced by this one, thieves may still read them
+    _Atomic(task*) items[];
+} deque_array;
+
+// Chase-Lev deque: the owner works at the bottom, thieves take from the top
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic int64_t top;
+    _Alignas(CACHE_LINE) _Atomic int64_t bottom;
+    _Atomic(deque_array*) array;
+} deque;
+
+typedef struct {
+    deque tasks;
+    scheduler* owner;
+    size_t index;
+    task* spare;            // finished tasks, only touched by the worker
+    size_t spareCount;
+    uint64_t rng;           // first victim to steal from
+    pthread_t thread;
+} worker;
+
+struct scheduler {
+    worker* workers;
+    size_t count;
+    atomic_bool stop;
+    atomic_size_t epoch;    // bumped by every spawn, an idle worker parks only if it did not change
+    atomic_size_t sleepers;
+    atomic_size_t queued;
+    pthread_mutex_t lock;
+    pthread_cond_t work;    // parked workers
+    pthread_cond_t done;    // threads outside the pool waiting for a group
+    task* queue;            // tasks spawned outside the pool, oldest first, under lock
+    task* queueTail;
+};
+
+typedef struct {
+    scheduler_range_fn fn;
+    void* arg;
+    size_t grain;
+} range;
+
+static _Thread_local worker* current;
+
+static deque_array* array_new(int64_t capacity, deque_array* retired) {
+    deque_array* a = malloc(sizeof(deque_array) + (size_t)capacity * sizeof(_Atomic(task*)));
+    a->capacity = capacity;
+    a->retired = retired;
+    return a;
+}
+
+static void deque_init(deque* d) {
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    atomic_init(&d->array, array_new(DEQUE_CAPACITY, NULL));
+}
+
+static void deque_free(deque* d) {
+    deque_array* a = atomic_load_explicit(&d->array, memory_order_relaxed);
+    while (a) {
+        deque_array* retired = a->retired;
+        free(a);
+        a = retired;
+    }
+}
+
+static _Atomic(task*)* deque_slot(deque_array* a, int64_t i) {
+    return &a->items[i & (a->capacity - 1)];
+}
+
+static void deque_push(deque* d, task* t) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&d->top, memory_order_acquire);
+    deque_array* a = atomic_load_explicit(&d->array, memory_order_relaxed);
+    if (b - top > a->capacity - 1) {
+        deque_array* grown = array_new(a->capacity * 2, a);
+        for (int64_t i = top; i < b; i++) {
+            atomic_store_explicit(deque_slot(grown, i),
+                                  atomic_load_explicit(deque_slot(a, i), memory_order_relaxed), memory_order_relaxed);
+        }
+        atomic_store_explicit(&d->array, grown, memory_order_release);
+        a = grown;
+    }
+    atomic_store_explicit(deque_slot(a, b), t, memory_order_relaxed);
+    // the task is published with the new bottom
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+}
+
+static task* deque_take(deque* d) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    deque_array* a = atomic_load_explicit(&d->array, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_relaxed);
+    if (t > b) {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    task* x = atomic_load_explicit(deque_slot(a, b), memory_order_relaxed);
+    if (t == b) {
+        // the last task, a thief may be taking it from the top
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            x = NULL;
+        }
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return x;
+}
+
+// NULL when the deque is empty or another thread won the race, lost tells them apart
+static task* deque_steal(deque* d, bool* lost) {
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    *lost = false;
+    if (t >= b) {
+        return NULL;
+    }
+    deque_array* a = atomic_load_explicit(&d->array, memory_order_acquire);
+    task* x = atomic_load_explicit(deque_slot(a, t), memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        *lost = true;
+        return NULL;
+    }
+    return x;
+}
+
+static worker* worker_of(const scheduler* s) {
+    return current && current->owner == s ? current : NULL;
+}
+
+static task* task_new(worker* w) {
+    if (w && w->spare) {
+        task* t = w->spare;
+        w->spare = t->next;
+        w->spareCount--;
+        return t;
+    }
+    return malloc(sizeof(task));
+}
+
+static void task_release(worker* w, task* t) {
+    if (w->spareCount < FREE_TASKS) {
+        t->next = w->spare;
+        w->spare = t;
+        w->spareCount++;
+    } else {
+        free(t);
+    }
+}
+
+static void spawn(scheduler* s, scheduler_group* g, void (*run)(task*, size_t), scheduler_fn fn, void* arg,
+                  size_t begin, size_t end) {
+    worker* w = worker_of(s);
+    task* t = task_new(w);
+    *t = (task){ run, fn, arg, g, begin, end, NULL };
+    atomic_fetch_add_explicit(&g->pending, 1, memory_order_relaxed);
+    if (w) {
+        deque_push(&w->tasks, t);
+    } else {
+        atomic_store_explicit(&g->external, true, memory_order_relaxed);
+        pthread_mutex_lock(&s->lock);
+        if (s->queueTail) {
+            s->queueTail->next = t;
+        } else {
+            s->queue = t;
+        }
+        s->queueTail = t;
+        atomic_fetch_add_explicit(&s->queued, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&s->lock);
+    }
+    // a worker about to park sees the new epoch, or it is counted in sleepers and gets the signal
+    atomic_fetch_add(&s->epoch, 1);
+    if (atomic_load(&s->sleepers)) {
+        pthread_mutex_lock(&s->lock);
+        pthread_cond_signal(&s->work);
+        pthread_mutex_unlock(&s->lock);
+    }
+}
+
+static task* find_task(worker* w) {
+    scheduler* s = w->owner;
+    task* t = deque_take(&w->tasks);
+    if (t) {
+        return t;
+    }
+    if (atomic_load_explicit(&s->queued, memory_order_relaxed)) {
+        pthread_mutex_lock(&s->lock);
+        if ((t = s->queue) != NULL) {
+            s->queue = t->next;
+            if (!s->queue) {
+                s->queueTail = NULL;
+            }
+            atomic_fetch_sub_explicit(&s->queued, 1, memory_order_relaxed);
+        }
+        pthread_mutex_unlock(&s->lock);
+        if (t) {
+            return t;
+        }
+    }
+    // xorshift, so the thieves do not all start at the same victim
+    w->rng ^= w->rng << 13;
+    w->rng ^= w->rng >> 7;
+    w->rng ^= w->rng << 17;
+    size_t first = (size_t)(w->rng % s->count);
+    for (size_t k = 0; k < s->count; k++) {
+        worker* victim = &s->workers[(first + k) % s->count];
+        if (victim == w) {
+            continue;
+        }
+        bool lost;
+        do {
+            t = deque_steal(&victim->tasks, &lost);
+        } while (lost);
+        if (t) {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+static void task_runOn(worker* w, task* t) {
+    scheduler* s = w->owner;
+    scheduler_group* g = t->group;
+    t->run(t, w->index);
+    task_release(w, t);
+    // the group may be gone once the count is 0, so whether a thread sleeps on it is read before
+    bool external = atomic_load_explicit(&g->external, memory_order_relaxed);
+    if (atomic_fetch_sub_explicit(&g->pending, 1, memory_order_acq_rel) == 1 && external) {
+        pthread_mutex_lock(&s->lock);
+        pthread_cond_broadcast(&s->done);
+        pthread_mutex_unlock(&s->lock);
+    }
+}
+
+static void run_plain(task* t, size_t index) {
+    t->fn(t->arg, index);
+}
+
+// splits off the upper half until the part is small enough, thieves take the biggest parts first
+static void run_range(task* t, size_t index) {
+    range* r = t->arg;
+    size_t begin = t->begin, end = t->end;
+    while (end - begin > r->grain) {
+        size_t middle = begin + (end - begin) / 2;
+        spawn(current->owner, t->group, run_range, NULL, r, middle, end);
+        end = middle;
+    }
+    r->fn(r->arg, begin, end, index);
+}
+
+static void* worker_main(void* arg) {
+    worker* w = arg;
+    scheduler* s = w->owner;
+    current = w;
+    size_t idle = 0;
+    while (!atomic_load_explicit(&s->stop, memory_order_acquire)) {
+        size_t seen = atomic_load(&s->epoch);
+        task* t = find_task(w);
+        if (t) {
+            task_runOn(w, t);
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            sched_yield();
+            continue;
+        }
+        pthread_mutex_lock(&s->lock);
+        atomic_fetch_add(&s->sleepers, 1);
+        if (atomic_load(&s->epoch) == seen && !atomic_load(&s->stop)) {
+            pthread_cond_wait(&s->work, &s->lock);
+        }
+        atomic_fetch_sub(&s->sleepers, 1);
+        pthread_mutex_unlock(&s->lock);
+        idle = 0;
+    }
+    return NULL;
+}
+
+scheduler* scheduler_create(size_t threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    scheduler* s = malloc(sizeof(scheduler));
+    s->count = threads;
+    s->workers = aligned_alloc(CACHE_LINE, threads * sizeof(worker));
+    atomic_init(&s->stop, false);
+    atomic_init(&s->epoch, 0);
+    atomic_init(&s->sleepers, 0);
+    atomic_init(&s->queued, 0);
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->work, NULL);
+    pthread_cond_init(&s->done, NULL);
+    s->queue = s->queueTail = NULL;
+    for (size_t i = 0; i < threads; i++) {
+        worker* w = &s->workers[i];
+        deque_init(&w->tasks);
+        w->owner = s;
+        w->index = i;
+        w->spare = NULL;
+        w->spareCount = 0;
+        w->rng = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+    }
+    for (size_t i = 0; i < threads; i++) {
+        pthread_create(&s->workers[i].thread, NULL, worker_main, &s->workers[i]);
+    }
+    return s;
+}
+
+void scheduler_destroy(scheduler* s) {
+    pthread_mutex_lock(&s->lock);
+    atomic_store(&s->stop, true);
+    pthread_cond_broadcast(&s->work);
+    pthread_mutex_unlock(&s->lock);
+    for (size_t i = 0; i < s->count; i++) {
+        pthread_join(s->workers[i].thread, NULL);
+    }
+    for (size_t i = 0; i < s->count; i++) {
+        worker* w = &s->workers[i];
+        deque_free(&w->tasks);
+        while (w->spare) {
+            task* t = w->spare;
+            w->spare = t->next;
+            free(t);
+        }
+    }
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->work);
+    pthread_cond_destroy(&s->done);
+    free(s->workers);
+    free(s);
+}
+
+static pthread_mutex_t sharedLock = PTHREAD_MUTEX_INITIALIZER;
+static scheduler* shared;
+
+static void shared_stop(void) {
+    scheduler_destroy(shared);
+    shared = NULL;
+}
+
+scheduler* scheduler_shared(size_t threads) {
+    pthread_mutex_lock(&sharedLock);
+    if (!shared) {
+        shared = scheduler_create(threads);
+        atexit(shared_stop);
+    }
+    pthread_mutex_unlock(&sharedLock);
+    return shared;
+}
+
+size_t scheduler_workers(const scheduler* s) {
+    return s->count;
+}
+
+void scheduler_spawn(scheduler* s, scheduler_group* g, scheduler_fn fn, void* arg) {
+    spawn(s, g, run_plain, fn, arg, 0, 0);
+}
+
+void scheduler_wait(scheduler* s, scheduler_group* g) {
+    worker* w = worker_of(s);
+    if (w) {
+        while (atomic_load_explicit(&g->pending, memory_order_acquire)) {
+            task* t = find_task(w);
+            if (t) {
+                task_runOn(w, t);
+            } else {
+                sched_yield();
+            }
+        }
+        return;
+    }
+    pthread_mutex_lock(&s->lock);
+    while (atomic_load(&g->pending)) {
+        pthread_cond_wait(&s->done, &s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+void scheduler_for(scheduler* s, size_t count, size_t grain, scheduler_range_fn fn, void* arg) {
+    if (count == 0) {
+        return;
+    }
+    range r = { fn, arg, grain ? grain : 1 };
+    scheduler_group g = SCHEDULER_GROUP_INIT;
+    spawn(s, &g, run_range, NULL, &r, 0, count);
+    scheduler_wait(s, &g);
+}
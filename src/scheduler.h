@@ -0,0 +1,94 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+/** @file scheduler.h */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @addtogroup Scheduler
+* work-stealing task scheduler shared by the parallel parts of the program.
+* every worker owns a Chase-Lev deque: it pushes and takes tasks at the bottom,
+* idle workers steal from the top of the others. threads outside the pool hand
+* their tasks to a shared queue and sleep until the tasks they wait for are done.
+* workers with nothing to do park on a condition variable until a task is spawned.
+* a task waiting for a group runs other tasks meanwhile, on the same worker index,
+* so per-worker scratch must not be held across scheduler_wait
+* @{
+*/
+
+typedef struct scheduler scheduler;
+
+/** task body, worker is the index of the worker running it, below scheduler_workers */
+typedef void (*scheduler_fn)(void* arg, size_t worker);
+
+/** body of a parallel loop over [begin, end) */
+typedef void (*scheduler_range_fn)(void* arg, size_t begin, size_t end, size_t worker);
+
+/** tasks to wait for together, initialize with SCHEDULER_GROUP_INIT */
+typedef struct {
+    atomic_size_t pending;
+    atomic_bool external;   // a thread outside the pool spawned into it and sleeps on it
+} scheduler_group;
+
+#define SCHEDULER_GROUP_INIT { 0, 0 }
+/** @} */
+
+/**
+* start a scheduler.
+* @param [in] threads amount of workers, 0 uses one per online cpu
+* @return scheduler, free with scheduler_destroy
+*/
+scheduler* scheduler_create(size_t threads);
+
+/**
+* stop the workers and free the scheduler, no task may be pending.
+* @param [in] s scheduler
+*/
+void scheduler_destroy(scheduler* s);
+
+/**
+* scheduler of the process, started by the first call and stopped at exit.
+* later calls get the same scheduler whatever amount of threads they ask for
+* @param [in] threads amount of workers of the first call, 0 uses one per online cpu
+* @return shared scheduler
+*/
+scheduler* scheduler_shared(size_t threads);
+
+/**
+* amount of workers.
+* @param [in] s scheduler
+* @return amount of workers
+*/
+size_t scheduler_workers(const scheduler* s);
+
+/**
+* queue a task, a worker pushes it on its own deque.
+* @param [in] s scheduler
+* @param [in,out] g group the task counts in
+* @param [in] fn task body
+* @param [in] arg argument of the body
+*/
+void scheduler_spawn(scheduler* s, scheduler_group* g, scheduler_fn fn, void* arg);
+
+/**
+* wait until every task of the group is done.
+* a worker runs other tasks while it waits, another thread sleeps
+* @param [in] s scheduler
+* @param [in,out] g group to wait for
+*/
+void scheduler_wait(scheduler* s, scheduler_group* g);
+
+/**
+* run a loop body over [0, count) in parallel and wait for it.
+* the range is split in halves until a part is at most grain long,
+* the halves are spawned so idle workers steal the big ones first
+* @param [in] s scheduler
+* @param [in] count length of the range
+* @param [in] grain longest part run by one call of the body, 0 is taken as 1
+* @param [in] fn loop body
+* @param [in] arg argument of the body
+*/
+void scheduler_for(scheduler* s, size_t count, size_t grain, scheduler_range_fn fn, void* arg);
+
+#endif
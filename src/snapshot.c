@@ -0,0 +1,49 @@
+#include "snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void snapshot_init(board_snapshot* snap, const sized_board* base) {
+    // until the first write the snapshot is the base itself
+    *snap = (board_snapshot){ { base->tiles, base->size }, base, NULL, NULL, 0 };
+}
+
+void snapshot_place(board_snapshot* snap, size_t row, size_t column, tile* t) {
+    size_t size = snap->base->size;
+    if (snap->board.tiles == snap->base->tiles) {
+        // the row array is per snapshot, the rows in it are still the ones of the base
+        snap->board.tiles = malloc(size * sizeof(tile**));
+        memcpy(snap->board.tiles, snap->base->tiles, size * sizeof(tile**));
+        snap->copies = calloc(size, sizeof(tile**));
+        snap->written = malloc(size * sizeof(size_t));
+    }
+    if (snap->board.tiles[row] == snap->base->tiles[row]) {
+        if (!snap->copies[row]) {
+            snap->copies[row] = malloc(size * sizeof(tile*));
+        }
+        memcpy(snap->copies[row], snap->base->tiles[row], size * sizeof(tile*));
+        snap->board.tiles[row] = snap->copies[row];
+        snap->written[snap->writtenCount++] = row;
+    }
+    snap->board.tiles[row][column] = t;
+}
+
+void snapshot_reset(board_snapshot* snap) {
+    for (size_t k = 0; k < snap->writtenCount; ++k) {
+        size_t row = snap->written[k];
+        snap->board.tiles[row] = snap->base->tiles[row];
+    }
+    snap->writtenCount = 0;
+}
+
+void snapshot_free(board_snapshot* snap) {
+    if (snap->board.tiles != snap->base->tiles) {
+        for (size_t i = 0; i < snap->base->size; ++i) {
+            free(snap->copies[i]);
+        }
+        free(snap->copies);
+        free(snap->written);
+        free(snap->board.tiles);
+    }
+    snapshot_init(snap, snap->base);
+}
@@ -0,0 +1,55 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+/** @file snapshot.h */
+
+#include "board.h"
+
+/** @addtogroup Snapshot
+* copy-on-write version of a board for speculative placements.
+* the snapshot reads through the rows of its base until it writes one, a written row is copied
+* once and kept for later writes. tiles are never copied, the snapshot shares them with the base,
+* so the base must not change while snapshots of it are in use.
+* every worker can take its own snapshot of the same base and place tiles on it,
+* readers like the scorer see the snapshot through its board
+* @{
+*/
+
+typedef struct {
+    sized_board board;          // the snapshot as readers see it, rows of the base until written
+    const sized_board* base;
+    tile*** copies;             // copy of a row, allocated when the row is first written
+    size_t* written;            // rows pointing to their copy since the last reset
+    size_t writtenCount;
+} board_snapshot;
+/** @} */
+
+/**
+* takes a snapshot of a board without copying anything.
+* @param [out] snap snapshot
+* @param [in] base board, must outlive the snapshot and stay unchanged
+*/
+void snapshot_init(board_snapshot* snap, const sized_board* base);
+
+/**
+* places a tile or NULL, the row is copied from the base if this is its first write.
+* the tile is not owned by the snapshot
+* @param [in,out] snap snapshot
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @param [in] t tile to place, NULL empties the cell
+*/
+void snapshot_place(board_snapshot* snap, size_t row, size_t column, tile* t);
+
+/**
+* drops every placement, the snapshot reads the base again. keeps the copied rows for reuse
+* @param [in,out] snap snapshot
+*/
+void snapshot_reset(board_snapshot* snap);
+
+/**
+* frees the copied rows, the tiles stay with their owners.
+* @param [in,out] snap snapshot
+*/
+void snapshot_free(board_snapshot* snap);
+
+#endif
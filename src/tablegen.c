@@ -0,0 +1,196 @@
+#include "tile_tables.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// writes the tile_infos table for every tile code, computing each entry from the
+// code digits and checking it against the runtime tile functions before it is written
+
+static void decode(size_t code, element edges[4], modifier* mod) {
+    *mod = (modifier)(code % 5);
+    code /= 5;
+    for (int d = WEST; d >= NORTH; d--) {
+        edges[d] = (element)(code % 3);
+        code /= 3;
+    }
+}
+
+static size_t encode(const element edges[4], modifier mod) {
+    size_t pattern = 0;
+    for (int d = NORTH; d <= WEST; d++) {
+        pattern = pattern * 3 + (size_t)edges[d];
+    }
+    return pattern * 5 + (size_t)mod;
+}
+
+static tile_info compute(size_t code) {
+    element edges[4];
+    modifier mod;
+    tile_info info;
+    memset(&info, 0, sizeof(info));
+    decode(code, edges, &mod);
+
+    for (int d = NORTH; d <= WEST; d++) {
+        info.sides[edges[d]][info.segments[edges[d]]++] = (uint8_t)d;
+        info.edges = (uint8_t)(info.edges | (unsigned)edges[d] << (2 * d));
+    }
+
+    if (edges[NORTH] == edges[SOUTH] && edges[EAST] == edges[WEST]) {
+        info.rotations = edges[NORTH] == edges[EAST] ? 1 : 2;
+    } else {
+        info.rotations = 4;
+    }
+
+    // castle rules of the scoring: one side or two sides of different castles
+    // are castles by themselves, otherwise all castle sides form one castle
+    uint8_t castles = info.segments[CASTLE];
+    if (castles == 0) {
+        info.castleGroups = 0;
+        info.castleGroupSize = 0;
+    } else if (castles == 1 || (castles == 2 && mod != CITY)) {
+        info.castleGroups = castles;
+        info.castleGroupSize = 1;
+    } else {
+        info.castleGroups = 1;
+        info.castleGroupSize = castles;
+    }
+
+    info.castleBonus = castles > 0 && mod == SHIELD;
+    info.roadEnds = mod == CROSSROASDS || mod == TEMPLE || info.segments[ROAD] == 1;
+    info.temple = mod == TEMPLE;
+    // only none, shield and temple have a character, the others are written as none
+    info.parsedMod = (uint8_t)(mod == SHIELD || mod == TEMPLE ? mod : NONE);
+    if (info.segments[ROAD] > 2) {
+        info.parsedMod = CROSSROASDS;
+    }
+
+    element rotated[4] = { edges[WEST], edges[NORTH], edges[EAST], edges[SOUTH] };
+    info.rotated = (uint16_t)encode(rotated, mod);
+    return info;
+}
+
+static bool check(size_t code, const tile_info* info) {
+    element edges[4];
+    modifier mod;
+    decode(code, edges, &mod);
+
+    tile t = { side_new(edges[NORTH]), side_new(edges[EAST]), side_new(edges[SOUTH]), side_new(edges[WEST]), mod };
+    bool ok = tile_code(&t) == code;
+
+    for (element e = CASTLE; e <= FIELD; e++) {
+        direction sides[4];
+        size_t count = tile_fillSegments(&t, e, sides);
+        ok &= count == info->segments[e] && tile_numOfSegments(&t, e) == count;
+        for (size_t k = 0; k < count; k++) {
+            ok &= sides[k] == info->sides[e][k];
+        }
+    }
+    for (direction d = NORTH; d <= WEST; d++) {
+        ok &= tile_getSideElement(&t, d) == (element)((info->edges >> (2 * d)) & 3u);
+    }
+
+    size_t rotations = tile_isSymmetric(&t) ? (tile_isUniform(&t) ? 1 : 2) : 4;
+    ok &= rotations == info->rotations;
+    ok &= (tile_hasCastle(&t) && tile_hasShield(&t)) == (info->castleBonus != 0);
+    ok &= (tile_hasCrossroads(&t) || tile_hasTemple(&t) || tile_numOfSegments(&t, ROAD) == 1) == (info->roadEnds != 0);
+    ok &= tile_hasTemple(&t) == (info->temple != 0);
+    ok &= (size_t)info->castleGroups * info->castleGroupSize == info->segments[CASTLE];
+
+    char str[5];
+    tile parsed;
+    tile_from_str(tile_to_str(&t, str), &parsed);
+    ok &= tile_getCenter(&parsed) == (modifier)info->parsedMod;
+    tile_free(&parsed);
+
+    tile_rotate(&t);
+    ok &= tile_code(&t) == info->rotated;
+    tile_free(&t);
+    return ok;
+}
+
+// set of the tiles fitting a constraint, checked side by side with the tile functions
+static bool computeFitting(unsigned constraint, edge_set* set) {
+    memset(set, 0, sizeof(*set));
+    bool ok = true;
+    for (size_t code = 0; code < TILE_CODES; code += 5) {
+        element edges[4];
+        modifier mod;
+        decode(code, edges, &mod);
+        tile t = { side_new(edges[NORTH]), side_new(edges[EAST]), side_new(edges[SOUTH]), side_new(edges[WEST]), mod };
+        bool fits = true, expected = true;
+        uint8_t packed = 0;
+        for (direction d = NORTH; d <= WEST; d++) {
+            unsigned want = (constraint >> (2 * d)) & 3u;
+            fits &= want == TILE_SIDE_ANY || want == (unsigned)edges[d];
+            expected &= want == TILE_SIDE_ANY || (element)want == tile_getSideElement(&t, d);
+            packed = (uint8_t)(packed | (unsigned)edges[d] << (2 * d));
+        }
+        ok &= fits == expected;
+        if (fits) {
+            edge_set_add(set, packed);
+        }
+        tile_free(&t);
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        puts("Wrong input!\n"
+             "Format: [OUTPUT_FILE]");
+        return EXIT_FAILURE;
+    }
+
+    static tile_info infos[TILE_CODES];
+    for (size_t code = 0; code < TILE_CODES; code++) {
+        infos[code] = compute(code);
+        if (!check(code, &infos[code])) {
+            fprintf(stderr, "tablegen: entry %zu does not match the tile functions\n", code);
+            return EXIT_FAILURE;
+        }
+    }
+
+    static edge_set fitting[TILE_CONSTRAINTS];
+    for (unsigned constraint = 0; constraint < TILE_CONSTRAINTS; constraint++) {
+        if (!computeFitting(constraint, &fitting[constraint])) {
+            fprintf(stderr, "tablegen: fitting tiles of constraint %u do not match the tile functions\n", constraint);
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (!out) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    fputs("// generated by tablegen, do not edit\n"
+          "#include \"tile_tables.h\"\n\n"
+          "const tile_info tile_infos[TILE_CODES] = {\n", out);
+    for (size_t code = 0; code < TILE_CODES; code++) {
+        const tile_info* i = &infos[code];
+        element edges[4];
+        modifier mod;
+        decode(code, edges, &mod);
+        fprintf(out, "    /* %3zu %c%c%c%c %d */ { { %u, %u, %u }, { ", code,
+                elem_to_char(edges[NORTH]), elem_to_char(edges[EAST]),
+                elem_to_char(edges[SOUTH]), elem_to_char(edges[WEST]), (int)mod,
+                i->segments[0], i->segments[1], i->segments[2]);
+        for (int e = 0; e < 3; e++) {
+            fprintf(out, "{ %u, %u, %u, %u }%s", i->sides[e][0], i->sides[e][1],
+                    i->sides[e][2], i->sides[e][3], e < 2 ? ", " : " }, ");
+        }
+        fprintf(out, "%u, %u, %u, %u, %u, %u, %u, %u, %u },\n", i->edges, i->rotations,
+                i->castleGroups, i->castleGroupSize, i->castleBonus, i->roadEnds,
+                i->temple, i->parsedMod, i->rotated);
+    }
+    fputs("};\n\n"
+          "const edge_set tile_fitting[TILE_CONSTRAINTS] = {\n", out);
+    for (unsigned constraint = 0; constraint < TILE_CONSTRAINTS; constraint++) {
+        const uint64_t* w = fitting[constraint].words;
+        fprintf(out, "    /* %3u */ { { 0x%016llxULL, 0x%016llxULL, 0x%016llxULL, 0x%016llxULL } },\n", constraint,
+                (unsigned long long)w[0], (unsigned long long)w[1], (unsigned long long)w[2], (unsigned long long)w[3]);
+    }
+    fputs("};\n", out);
+    return fclose(out) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,48 @@
+#include "temples.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// the tile is counted on its neighbours when delta is 1 and taken off again when it is -1
+static void temples_update(temple_tracker* t, const sized_board* board, size_t row, size_t column, int delta) {
+    bool temple = tile_hasTemple(board->tiles[row][column]);
+    size_t centre = (row + 1) * t->stride + column + 1;
+    for (size_t r = centre - t->stride; r <= centre + t->stride; r += t->stride) {
+        for (size_t c = r - 1; c <= r + 1; c++) {
+            if (c != centre) {
+                t->occupied[c] = (uint8_t)(t->occupied[c] + delta);
+                t->temples[c] = (uint8_t)(t->temples[c] + delta * temple);
+            }
+        }
+    }
+    t->score += delta * temples_gain(t, row, column, temple);
+}
+
+void temples_init(temple_tracker* t, const sized_board* board) {
+    t->size = board->size;
+    t->stride = board->size + 2;
+    t->occupied = calloc(t->stride * t->stride, sizeof(uint8_t));
+    t->temples = calloc(t->stride * t->stride, sizeof(uint8_t));
+    t->score = 0;
+    for (size_t i = 0; i < board->size; i++) {
+        for (size_t j = 0; j < board->size; j++) {
+            if (board->tiles[i][j]) {
+                temples_update(t, board, i, j, 1);
+            }
+        }
+    }
+}
+
+void temples_free(temple_tracker* t) {
+    free(t->occupied);
+    free(t->temples);
+    memset(t, 0, sizeof(*t));
+}
+
+void temples_place(temple_tracker* t, const sized_board* board, size_t row, size_t column) {
+    temples_update(t, board, row, column, 1);
+}
+
+void temples_remove(temple_tracker* t, const sized_board* board, size_t row, size_t column) {
+    temples_update(t, board, row, column, -1);
+}
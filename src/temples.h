@@ -0,0 +1,90 @@
+#ifndef TEMPLES_H
+#define TEMPLES_H
+/** @file temples.h */
+
+#include "board.h"
+
+#include <stdint.h>
+
+/** @addtogroup Temples
+* neighbour counts of every cell and the temple points of a board, kept up to date tile by tile.
+* a temple scores 1 plus its occupied neighbours, so placing or taking back a tile
+* only changes the counts of the eight cells around it and the total by the temples among them.
+* the counts are padded with an empty ring, the cells around the border need no bounds checks
+* @{
+*/
+typedef struct {
+    size_t size;            // side of the tracked board
+    size_t stride;          // size + 2, cell (row, column) is at (row + 1) * stride + column + 1
+    uint8_t* occupied;      // occupied cells among the eight around every cell
+    uint8_t* temples;       // temples among the eight around every cell
+    int score;              // points of all temples on the board
+} temple_tracker;
+/** @} */
+
+/**
+* count the neighbours of every cell of a board with one scan.
+* @param [out] t tracker
+* @param [in] board board to track, its size has to stay the same while it is tracked
+*/
+void temples_init(temple_tracker* t, const sized_board* board);
+
+/**
+* free the memory of the tracker.
+* @param [in,out] t tracker
+*/
+void temples_free(temple_tracker* t);
+
+/**
+* update the counts after a tile was put on the board.
+* @param [in,out] t tracker of the board
+* @param [in] board board with the tile already placed
+* @param [in] row row of the placed tile
+* @param [in] column column of the placed tile
+*/
+void temples_place(temple_tracker* t, const sized_board* board, size_t row, size_t column);
+
+/**
+* update the counts before a tile is taken off the board, tiles can be taken in any order.
+* @param [in,out] t tracker of the board
+* @param [in] board board with the tile still placed
+* @param [in] row row of the tile
+* @param [in] column column of the tile
+*/
+void temples_remove(temple_tracker* t, const sized_board* board, size_t row, size_t column);
+
+/**
+* occupied cells around a cell, for a temple the points it has beyond its own.
+* @param [in] t tracker
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @return amount of occupied neighbours
+*/
+static inline int temples_occupiedAround(const temple_tracker* t, size_t row, size_t column) {
+    return t->occupied[(row + 1) * t->stride + column + 1];
+}
+
+/**
+* temples around a cell, each gains a point when the cell gets a tile.
+* @param [in] t tracker
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @return amount of temples among the neighbours
+*/
+static inline int temples_around(const temple_tracker* t, size_t row, size_t column) {
+    return t->temples[(row + 1) * t->stride + column + 1];
+}
+
+/**
+* temple points a tile placed on an empty cell would add.
+* @param [in] t tracker
+* @param [in] row row of the cell
+* @param [in] column column of the cell
+* @param [in] temple if the tile has a temple
+* @return gain of the temple score
+*/
+static inline int temples_gain(const temple_tracker* t, size_t row, size_t column, bool temple) {
+    return temples_around(t, row, column) + (temple ? 1 + temples_occupiedAround(t, row, column) : 0);
+}
+
+#endif
@@ -28,15 +28,29 @@ modifier mod_from_char(char ch) {
 
 tile* tile_from_str(const char str[static 5], tile* t) {
     if (t) {
-        t->up = side_new(elem_from_char(str[0]));
-        t->right = side_new(elem_from_char(str[1]));
-        t->down = side_new(elem_from_char(str[2]));
-        t->left = side_new(elem_from_char(str[3]));
-        t->mod = mod_from_char(str[4]);
-
-        if(tile_numOfSegments(t,ROAD)>2) {
-            t->mod = CROSSROASDS;
-        }
+        // parsed into sides on the stack, then every side gets memory of its own as tile_free expects
+        side parsed[4];
+        tile_from_str_into(str, t, parsed);
+        t->up = side_copy(t->up);
+        t->right = side_copy(t->right);
+        t->down = side_copy(t->down);
+        t->left = side_copy(t->left);
+    }
+    return t;
+}
+
+tile* tile_from_str_into(const char str[static 5], tile* t, side sides[static 4]) {
+    for (size_t i = 0; i < 4; ++i) {
+        sides[i] = (side){ elem_from_char(str[i]), COMPL_NOT_SET };
+    }
+    t->up = &sides[0];
+    t->right = &sides[1];
+    t->down = &sides[2];
+    t->left = &sides[3];
+    t->mod = mod_from_char(str[4]);
+
+    if(tile_numOfSegments(t,ROAD)>2) {
+        t->mod = CROSSROASDS;
     }
     return t;
 }
@@ -59,6 +73,19 @@ tile* tile_alloc_from_tile(const tile* orig) {
     return 0;
 }
 
+tile* tile_copy_into(const tile* orig, tile* t, side sides[static 4]) {
+    sides[0] = *orig->up;
+    sides[1] = *orig->right;
+    sides[2] = *orig->down;
+    sides[3] = *orig->left;
+    t->up = &sides[0];
+    t->right = &sides[1];
+    t->down = &sides[2];
+    t->left = &sides[3];
+    t->mod = orig->mod;
+    return t;
+}
+
 void tile_free(tile* t) {
     if (t) {
         side_free(&(t->up));
@@ -166,6 +193,12 @@ tile* tile_rotate_amount(rotation_t rot, tile* t) {
     return t;
 }
 
+size_t tile_code(const tile* t) {
+    size_t pattern = (((size_t)t->up->type * 3 + (size_t)t->right->type) * 3
+                      + (size_t)t->down->type) * 3 + (size_t)t->left->type;
+    return pattern * 5 + (size_t)t->mod;
+}
+
 bool tile_isEmpty(const tile* t) {
     return t == 0;
 }
@@ -259,6 +292,25 @@ direction* tile_getSegments(const tile* t, element type, size_t count) {
     return segments;
 }
 
+size_t tile_fillSegments(const tile* t, element type, direction segments[static 4]) {
+    size_t count = 0;
+
+    if (side_getType(t->up) == type) {
+        segments[count++] = NORTH;
+    }
+    if (side_getType(t->right) == type) {
+        segments[count++] = EAST;
+    }
+    if (side_getType(t->down) == type) {
+        segments[count++] = SOUTH;
+    }
+    if (side_getType(t->left) == type) {
+        segments[count++] = WEST;
+    }
+
+    return count;
+}
+
 void tile_freeSegments(direction** selfPtr) {
     free(*selfPtr);
     *selfPtr = NULL;
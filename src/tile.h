@@ -22,6 +22,9 @@ typedef struct {
 } tile;
 /** @} */
 
+/** amount of distinct tiles: 3^4 edge patterns times 5 modifiers */
+#define TILE_CODES 405
+
 /**
 * set tile pointer to valid memory.
 * remember to free this
@@ -54,6 +57,16 @@ modifier mod_from_char(char);
 */
 tile* tile_from_str(const char[static 5], tile*);
 
+/**
+* set tile values based on supplied string, the sides are stored in memory owned by the caller.
+* such a tile is not freed with {@code tile_free}, its memory goes with the sides
+* @param [in] str string length 5 specifying tile
+* @param [out] t tile being assigned to
+* @param [out] sides storage of the four sides
+* @return returns tile pointer
+*/
+tile* tile_from_str_into(const char[static 5], tile*, side[static 4]);
+
 /**
 * set tile pointer to valid memory and initialize according to string.
 * remember to free this
@@ -70,6 +83,15 @@ tile* tile_alloc_from_str(const char[static 5], tile**);
  */
 tile* tile_alloc_from_tile(const tile*);
 
+/**
+ * copy supplied tile, the sides are stored in memory owned by the caller.
+ * @param [in] orig pointer to tile to copy
+ * @param [out] t tile being assigned to
+ * @param [out] sides storage of the four sides
+ * @return pointer to the copy
+ */
+tile* tile_copy_into(const tile*, tile*, side[static 4]);
+
 /**
  * frees all Sides, not the tile pointer!
  * @param [in] t tile pointer to free
@@ -172,6 +194,14 @@ void rotation_print(rotation_t);
  */
 tile* tile_rotate_amount(rotation_t, tile*);
 
+/**
+ * number identifying the tile's edges and modifier, rotated tiles get different codes.
+ * code = (((up * 3 + right) * 3 + down) * 3 + left) * 5 + modifier
+ * @param [in] t tile pointer
+ * @return code in range [0, TILE_CODES)
+ */
+size_t tile_code(const tile*);
+
 /**
  * check if tile is empty.
  * @param [in] t tile pointer to check if no tile is placed there on the board
@@ -228,6 +258,15 @@ size_t tile_numOfSegments(const tile* self, element);
 
 direction* tile_getSegments(const tile*, element, size_t);
 
+/**
+ * write directions of sides with element to caller's array, no allocation.
+ * @param [in] t tile pointer
+ * @param [in] type element to look for
+ * @param [out] segments at least 4 cells long
+ * @return amount of segments written
+ */
+size_t tile_fillSegments(const tile*, element, direction[static 4]);
+
 /**
  * free segments set pointer to null.
  * @param [in,out] selfPtr segments pointer to pointer to free
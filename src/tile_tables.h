@@ -0,0 +1,114 @@
+#ifndef TILE_TABLES_H
+#define TILE_TABLES_H
+/** @file tile_tables.h */
+
+#include "tile.h"
+
+#include <stdint.h>
+
+/** @addtogroup TileTables
+* per tile code constants, the table itself is written by tablegen at build time
+* and checked there against the functions of tile.h
+* @{
+*/
+typedef struct {
+    /** amount of sides per element, indexed by element */
+    uint8_t segments[3];
+    /** directions of the sides per element, clockwise from north */
+    uint8_t sides[3][4];
+    /** side elements packed 2 bits each: north in bits 0-1 up to west in bits 6-7 */
+    uint8_t edges;
+    /** rotations giving distinct tiles: 1, 2 or 4 */
+    uint8_t rotations;
+    /** independent castles on the tile, each scored on its own */
+    uint8_t castleGroups;
+    /** castle sides belonging to one castle, 1 when every side is a castle by itself */
+    uint8_t castleGroupSize;
+    /** 1 when the tile has a castle and a shield */
+    uint8_t castleBonus;
+    /** 1 when a road entering the tile ends on it */
+    uint8_t roadEnds;
+    /** 1 when the tile has a temple */
+    uint8_t temple;
+    /** modifier tile_from_str assigns: crossroads for more than two roads */
+    uint8_t parsedMod;
+    /** code of the tile rotated clockwise once */
+    uint16_t rotated;
+} tile_info;
+
+/** table indexed by tile_code */
+extern const tile_info tile_infos[TILE_CODES];
+
+/** side of a constraint without a neighbour, every element fits it */
+#define TILE_SIDE_ANY 3
+/** amount of constraints: an element or TILE_SIDE_ANY packed 2 bits per side like tile_info::edges */
+#define TILE_CONSTRAINTS 256
+/** words of an edge_set */
+#define EDGE_SET_WORDS 4
+
+/** set of packed edges, bit e of the words stands for a tile with tile_info::edges e as placed */
+typedef struct {
+    uint64_t words[EDGE_SET_WORDS];
+} edge_set;
+
+/** tiles fitting a cell, indexed by the constraint of the cell: the edges of every
+* pattern in every rotation whose sides equal the constraint wherever it is not TILE_SIDE_ANY */
+extern const edge_set tile_fitting[TILE_CONSTRAINTS];
+/** @} */
+
+/**
+* look up the constants of a tile.
+* @param [in] t tile pointer, not empty
+* @return entry of tile_infos for the tile
+*/
+static inline const tile_info* tile_info_of(const tile* t) {
+    return &tile_infos[tile_code(t)];
+}
+
+/**
+* check if an edge of one tile matches the facing edge of another.
+* @param [in] a packed edges of the first tile
+* @param [in] dir side of the first tile facing the second one
+* @param [in] b packed edges of the second tile
+* @return if both edges have the same element
+*/
+static inline bool tile_edgesMatch(uint8_t a, direction dir, uint8_t b) {
+    unsigned shift = 2u * (unsigned)dir;
+    unsigned opposite = 2u * (((unsigned)dir + 2u) & 3u);
+    return ((a >> shift) & 3u) == ((b >> opposite) & 3u);
+}
+
+/**
+* add packed edges to a set.
+* @param [in,out] set edge set
+* @param [in] edges packed edges of a tile as placed
+*/
+static inline void edge_set_add(edge_set* set, uint8_t edges) {
+    set->words[edges >> 6] |= (uint64_t)1 << (edges & 63u);
+}
+
+/**
+* check if packed edges are in a set.
+* @param [in] set edge set
+* @param [in] edges packed edges of a tile as placed
+* @return if the edges are in the set
+*/
+static inline bool edge_set_has(const edge_set* set, uint8_t edges) {
+    return (set->words[edges >> 6] >> (edges & 63u)) & 1u;
+}
+
+/**
+* check if two sets share any edges, eg. tile_fitting of a cell and the edges of a pile.
+* @param [in] a first set
+* @param [in] b second set
+* @return if some edges are in both sets
+*/
+static inline bool edge_set_intersects(const edge_set* a, const edge_set* b) {
+    uint64_t common = 0;
+    for (size_t w = 0; w < EDGE_SET_WORDS; w++) {
+        common |= a->words[w] & b->words[w];
+    }
+    return common != 0;
+}
+
+#endif
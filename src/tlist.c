@@ -1,28 +1,10 @@
 #include "tlist.h"
+#include "fileio.h"
 
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
 
-bool tlist_parse(const char* filename, sized_tlist* list) {
-    if (!list || !list->tiles) {
-        return false;
-    }
-    FILE* file;
-    if ((file = fopen(filename, "r")) == 0) {
-        return false;
-    }
-    for (size_t i = 0; i < list->size; ++i) {
-        // if any tile parsing fails return false
-        if (!tile_parse(file, &list->tiles[i])) {
-            fclose(file);
-            return false;
-        }
-    }
-    fclose(file);
-    return true;
-}
-
 size_t tlist_get_len(const char* filename) {
     FILE* list = fopen(filename, "r");
     size_t count = 0;
@@ -40,32 +22,115 @@ size_t tlist_get_len(const char* filename) {
     return count;
 }
 
+// reads the whole file into memory, the list is parsed from there
+static char* read_file(const char* filename, size_t* length) {
+    FILE* file;
+    if ((file = fopen(filename, "rb")) == 0) {
+        return NULL;
+    }
+    long end;
+    if (fseek(file, 0, SEEK_END) != 0 || (end = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return NULL;
+    }
+    char* text = malloc((size_t)end + 1);
+    if (text) {
+        *length = fread(text, 1, (size_t)end, file);
+    }
+    fclose(file);
+    return text;
+}
+
+// allocates the pool and the slots, the sides of tile i are sides[4 * i] to sides[4 * i + 3]
+static bool pool_alloc(sized_tlist* list, size_t size, side** sides) {
+    list->size = size;
+    list->capacity = size;
+    list->order = TLIST_SWAP;
+    list->poolSize = size;
+    list->pool = malloc(size * (sizeof(tile) + 4 * sizeof(side)) + 1);
+    list->tiles = calloc(size ? size : 1, sizeof(tile*));
+    if (!list->pool || !list->tiles) {
+        free(list->pool);
+        free(list->tiles);
+        *list = (sized_tlist){ 0 };
+        return false;
+    }
+    *sides = (side*)(void*)(list->pool + size);
+    return true;
+}
+
 bool tlist_init(const char* filename, sized_tlist* list) {
-    list->size = tlist_get_len(filename);
-    list->tiles = calloc(list->size, sizeof(tile*));
-    return tlist_parse(filename, list);
+    *list = (sized_tlist){ 0 };
+    size_t length = 0;
+    char* text = read_file(filename, &length);
+    if (!text) {
+        return false;
+    }
+    // every tile is 5 characters, whitespace separates them and an empty slot is written as a tab
+    size_t chars = 0;
+    for (size_t i = 0; i < length; ++i) {
+        chars += !isspace((unsigned char)text[i]);
+    }
+    side* sides;
+    if (chars % 5 != 0 || !pool_alloc(list, chars / 5, &sides)) {
+        free(text);
+        return false;
+    }
+    char str[5];
+    for (size_t i = 0, used = 0, count = 0; i < length; ++i) {
+        if (isspace((unsigned char)text[i])) {
+            continue;
+        }
+        str[used++] = text[i];
+        if (used == 5) {
+            list->tiles[count] = tile_from_str_into(str, &list->pool[count], &sides[4 * count]);
+            ++count;
+            used = 0;
+        }
+    }
+    free(text);
+    return true;
 }
 
 sized_tlist tlist_init_exit_on_err(const char* filename) {
     sized_tlist list;
     if (!tlist_init(filename, &list)) {
-        free(list.tiles);
         fputs("error parsing tile list\n", stderr);
         exit(EXIT_FAILURE);
     }
     return list;
 }
 
+static bool pooled(const sized_tlist* list, const tile* t) {
+    return list->pool && t >= list->pool && t < list->pool + list->poolSize;
+}
+
 void tlist_free(sized_tlist* list) {
     for (size_t i = 0; i < list->size; ++i) {
-        tile_free(list->tiles[i]);
-        free(list->tiles[i]);
+        if (!pooled(list, list->tiles[i])) {
+            tile_free(list->tiles[i]);
+            free(list->tiles[i]);
+        }
         list->tiles[i] = 0;
     }
     free(list->tiles);
+    free(list->pool);
     list->tiles = 0;
+    list->pool = 0;
+    list->size = list->capacity = list->poolSize = 0;
 }
 
+void tlist_copy(const sized_tlist* src, sized_tlist* dest) {
+    side* sides;
+    if (!pool_alloc(dest, src->size, &sides)) {
+        fputs("error copying tile list\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    dest->order = src->order;
+    for (size_t i = 0; i < src->size; ++i) {
+        dest->tiles[i] = tile_copy_into(src->tiles[i], &dest->pool[i], &sides[4 * i]);
+    }
+}
 
 void tlist_print(const sized_tlist* list) {
     int counter = 1;            // separate counter for display
@@ -80,18 +145,20 @@ void tlist_print(const sized_tlist* list) {
 }
 
 bool tlist_write(const sized_tlist* list, const char* filename) {
-    FILE* file;
-    if ((file = fopen(filename, "w")) == 0) {
+    // a tile is 5 characters or a tab for an empty slot, one per line
+    char* text = malloc(list->size * 6 + 5);
+    if (!text) {
         return false;
     }
-    char str[5];
+    char* p = text;
     for (size_t i = 0; i < list->size; ++i) {
-        fprintf(file,
-                "%.*s\n", 5,
-                tile_to_str(list->tiles[i], str));
+        tile_to_str(list->tiles[i], p);
+        p += list->tiles[i] ? 5 : 1;
+        *p++ = '\n';
     }
-    fclose(file);
-    return true;
+    bool ok = fileio_write_atomic(filename, text, (size_t)(p - text));
+    free(text);
+    return ok;
 }
 
 tile* tlist_eraseAt(sized_tlist* list,int index) {
@@ -102,8 +169,29 @@ tile* tlist_eraseAt(sized_tlist* list,int index) {
     tile* t = list->tiles[index];
     (list->size)--;
 
-    for(int i = index; i < list->size; i++) {
-        list->tiles[i] = list->tiles[i+1];
+    if (list->order == TLIST_STABLE) {
+        memmove(list->tiles + index, list->tiles + index + 1, (list->size - (size_t)index) * sizeof(tile*));
+    } else {
+        list->tiles[index] = list->tiles[list->size];
     }
+    list->tiles[list->size] = 0;
     return t;
 }
+
+tile* tlist_detach(const sized_tlist* list, tile* t) {
+    return pooled(list, t) ? tile_alloc_from_tile(t) : t;
+}
+
+bool tlist_append(sized_tlist* list, tile* t) {
+    if (list->size == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        tile** tiles = realloc(list->tiles, capacity * sizeof(tile*));
+        if (!tiles) {
+            return false;
+        }
+        list->tiles = tiles;
+        list->capacity = capacity;
+    }
+    list->tiles[list->size++] = t;
+    return true;
+}
@@ -7,19 +7,22 @@
 #include <stdbool.h>
 
 typedef tile** tlist_t;
+
+/** how {@code tlist_eraseAt} closes the gap of a taken tile */
+typedef enum {
+    TLIST_SWAP,     // the last tile moves into the gap, O(1)
+    TLIST_STABLE,   // the tiles behind the gap move up, keeps the order of the file
+} tlist_order;
+
 typedef struct {
     tlist_t tiles;
     size_t size;
+    size_t capacity;    // slots allocated, taken tiles leave room to put them back
+    tlist_order order;
+    tile* pool;         // tiles of a loaded list followed by their sides, one allocation
+    size_t poolSize;    // tiles in the pool
 } sized_tlist;
 
-/**
-* assign tile values to tile array based on specified file.
-* @param [in] filename tile list file name
-* @param [out] list sized_tlist list
-* @return success of operation, return false if parse tile fails, list / tile is NULL
-*/
-bool tlist_parse(const char*, sized_tlist*);
-
 /**
 * reads file to find out how big tile list to allocate.
 * @param [in] filename name of tile list file
@@ -29,10 +32,11 @@ size_t tlist_get_len(const char*);
 
 /**
 * allocates and initializes tile list based on tile list file.
-* remeber to free this, if filename is bad program will exit
+* the file is read once, the tiles and their sides are stored in a single block sized from it.
+* remeber to free this, on failure the list is left empty
 * @param [in] filename name of the tile list file
 * @param [out] list pointer to sized_tlist struct
-* @return status of operation
+* @return status of operation, false if the file can't be read or a tile is incomplete
 */
 bool tlist_init(const char*, sized_tlist*);
 
@@ -53,10 +57,19 @@ void tlist_print(const sized_tlist*);
 
 /**
  * free tlist, set pointer to null.
+ * the pool goes in one call, only tiles added with {@code tlist_append} are freed one by one
  * @param [in,out] list sized_list pointer to free
  */
 void tlist_free(sized_tlist*);
 
+/**
+ * deep copy tlist, the tiles are copied into a pool of their own.
+ * remember to free the copy with {@code tlist_free}
+ * @param [in] src list to copy
+ * @param [out] dest list being initialized
+ */
+void tlist_copy(const sized_tlist*, sized_tlist*);
+
 /**
  * write tlist to file.
  * @param [in] list sized_tlist pointer, list of aviable tiles
@@ -65,11 +78,31 @@ void tlist_free(sized_tlist*);
 bool tlist_write(const sized_tlist*, const char*);
 
 /**
- * erases the tile at a concrete index from the list
+ * erases the tile at a concrete index from the list, the slot is kept for {@code tlist_append}.
+ * in TLIST_SWAP order the last tile takes the index, in TLIST_STABLE the tiles behind it move up.
+ * the tile may live in the pool, use {@code tlist_detach} to keep it after the list is freed
  * @param [in] list sized_tlist pointer, list of aviable tiles
  * @param [in] index of the tile to be erased form the list
  * @return the pointer to the erased tile
  */
 tile* tlist_eraseAt(sized_tlist*,int);
 
+/**
+ * hands a tile taken from the list to the caller, who frees it with {@code tile_free} and free.
+ * a tile of the pool is copied, any other is returned as it is
+ * @param [in] list sized_tlist pointer the tile was taken from
+ * @param [in] t tile taken with {@code tlist_eraseAt}
+ * @return tile owned by the caller
+ */
+tile* tlist_detach(const sized_tlist*, tile*);
+
+/**
+ * puts a tile at the end of the list, the list owns it afterwards.
+ * takes a slot freed by {@code tlist_eraseAt} without allocating, grows the list otherwise
+ * @param [in,out] list sized_tlist pointer, list of aviable tiles
+ * @param [in] t tile to add
+ * @return success of operation, false if the list could not grow
+ */
+bool tlist_append(sized_tlist*, tile*);
+
 #endif